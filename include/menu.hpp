@@ -26,6 +26,7 @@
 
 #	include <imenu.hpp>
 #	include <imenuhandler.hpp>
+#	include <imenusystem/isample.hpp>
 #	include "menu/provider.hpp"
 #	include "menu/schema/pointworldtext.hpp"
 
@@ -34,12 +35,17 @@
 #	include <basetypes.h>
 #	include <bitvec.h>
 #	include <const.h>
+#	include <tier1/utlmap.h>
 #	include <tier1/utlvector.h>
 
 #	define MENU_EMPTY_BACKGROUND_MATERIAL_NAME "materials/editor/icon_empty.vmat"
+#	define MENU_INVALID_VIEWER_INDEX -1
+#	define MENU_INVALID_ITEM_POSITION static_cast<IMenu::ItemPosition_t>(-1)
+#	define MENU_SENT_TEXT_HASH_SEED 0x4D454E55
 
 class IMenuHandler;
 class IMenuProfile;
+class CMenuTemplate; // See "menutemplate.hpp".
 
 struct CMenuData_t
 {
@@ -95,12 +101,13 @@ public:
 	using CPointWorldText_Helper = Menu::Schema::CPointWorldText_Helper;
 	using CGameData_BaseEntity = Menu::CProvider::CGameDataStorage::CBaseEntity;
 
-	CMenu(const CPointWorldText_Helper *pSchemaHelper, const CGameData_BaseEntity *pGameData, IMenuProfile *pProfile, IMenuHandler *pHandler = nullptr, CMenuData_t::ControlItems_t *pControls = nullptr);
+	CMenu(const CPointWorldText_Helper *pSchemaHelper, const CGameData_BaseEntity *pGameData, ISample *pSample, IMenuProfile *pProfile, IMenuHandler *pHandler = nullptr, CMenuData_t::ControlItems_t *pControls = nullptr);
 	~CMenu() override; // IMenuInstance destructor.
 
 	void Close(IMenuHandler::EndReason_t eReason);
 	void Destroy();
 	void Purge();
+	void Reset(IMenuProfile *pProfile = nullptr, IMenuHandler *pHandler = nullptr, CMenuData_t::ControlItems_t *pControls = nullptr); // Clears the state for reuse, keeping allocated containers.
 
 public:	// IMenuInstance
 	const IMenuProfile *GetProfile() const override
@@ -115,6 +122,17 @@ public:	// IMenuInstance
 		return m_pHandler;
 	}
 
+	// An external handler chained behind the interposing one.
+	IMenuHandler *GetNextHandler() const
+	{
+		return m_pNextHandler;
+	}
+
+	void SetNextHandler(IMenuHandler *pHandler)
+	{
+		m_pNextHandler = pHandler;
+	}
+
 	const CUtlVector<CEntityInstance *> &GetActiveEntities() const override
 	{
 		return *static_cast<const CUtlVector<CEntityInstance *> *>(this);
@@ -125,27 +143,114 @@ public:	// IMenuInstance
 		return m_bvPlayers;
 	}
 
+	struct ViewerState_t;
+
+	// Players who have the menu in their stacks, with their render states.
+	const CUtlVector<ViewerState_t *> &GetViewers() const
+	{
+		return m_vecViewers;
+	}
+
+	ViewerState_t *FindViewer(CPlayerSlot aSlot) const
+	{
+		int iViewer = m_arrViewerIndices[aSlot.GetClientIndex()];
+
+		return iViewer == MENU_INVALID_VIEWER_INDEX ? nullptr : m_vecViewers[iViewer];
+	}
+
+	bool AddViewer(CPlayerSlot aSlot);
+	void SetViewerPosition(CPlayerSlot aSlot, ItemPosition_t iItem); // Adds the viewer if not, the page of the item is rendered by the next display.
+	bool RemoveViewer(CPlayerSlot aSlot);
+	void RemoveAllViewers();
+
 	void Emit(const CUtlVector<CEntityInstance *> &vecEntites) override;
 
+public: // Templates.
+	CMenuTemplate *GetTemplate() const
+	{
+		return m_pTemplate;
+	}
+
+	bool IsTemplateDetached() const
+	{
+		return m_bTemplateDetached;
+	}
+
+	bool IsSharingPages() const
+	{
+		return m_bSharePages;
+	}
+
+	void AttachTemplate(CMenuTemplate *pTemplate, bool bSharePages = true); // References the template data instead of own.
+	void DetachTemplate(); // Copies the template data on write.
+	void ReleaseTemplate();
+
+	const CMenuData_t &GetData() const;
+	CMenuData_t &GetData();
+
 public: // IMenu
 	Title_t &GetTitleRef() override
 	{
+		DetachTemplate();
+		MarkContentChanged();
+
 		return m_aData.m_title;
 	}
 
 	Items_t &GetItemsRef() override
 	{
+		DetachTemplate();
+		MarkContentChanged();
+
 		return m_aData.m_vecItems;
 	}
 
 	ItemControlFlags_t &GetItemControlsRef() override
 	{
+		DetachTemplate();
+		MarkContentChanged();
+
 		return m_aData.m_eControlFlags;
 	}
 
+	const Title_t &GetTitle() const override
+	{
+		return GetData().m_title;
+	}
+
+	const Items_t &GetItems() const override
+	{
+		return GetData().m_vecItems;
+	}
+
+	ItemControlFlags_t GetItemControls() const override
+	{
+		return GetData().m_eControlFlags;
+	}
+
+	ItemPosition_t AddItem(const Item_t &aItem) override;
+	bool RemoveItem(ItemPosition_t iItem) override;
+	bool SetItemContent(ItemPosition_t iItem, const char *pszContent) override;
+	bool SetItemStyle(ItemPosition_t iItem, ItemStyleFlags_t eStyle) override;
+
+	int GetPageCount() override;
+	ItemPosition_t GetPageStartItem(int iPage) override;
+	int GetPageOfItem(ItemPosition_t iItem) override;
+
+	void SetItemSource(IItemSource *pSource) override;
+
+	IItemSource *GetItemSource() const override
+	{
+		return m_pItemSource;
+	}
+
+	void MarkItemsChanged(ItemPosition_t iFirst, ItemPosition_t iLast) override; // Extends the changed range.
+
 	ItemPosition_t GetCurrentPosition(CPlayerSlot aSlot) const override
 	{
-		return m_arrCurrentPositions[aSlot.GetClientIndex()];
+		const auto *pViewer = FindViewer(aSlot);
+
+		return pViewer ? pViewer->m_iCurrentPosition : -1;
 	}
 
 	class CBufferStringText : public CBufferString
@@ -163,6 +268,126 @@ public: // IMenu
 		char m_FixedData[sm_nDataSize];
 	};
 
+	// Appends lines to all page layers in one pass, tracking their lengths against the capacity.
+	class CLayerWriter
+	{
+	public:
+		using LayerMask_t = uint8;
+
+		enum : LayerMask_t // By MenuEntity_t.
+		{
+			MENU_LAYER_TEXT = (1 << MENU_ENTITY_BACKGROUND_INDEX),
+			MENU_LAYER_INACTIVE = (1 << MENU_ENTITY_INACTIVE_INDEX),
+			MENU_LAYER_ACTIVE = (1 << MENU_ENTITY_ACTIVE_INDEX),
+			MENU_LAYER_DISABLED_ACTIVE = (1 << MENU_ENTITY_DISABLED_ACTIVE_INDEX),
+
+			MENU_LAYER_ALL = (MENU_LAYER_TEXT | MENU_LAYER_INACTIVE | MENU_LAYER_ACTIVE | MENU_LAYER_DISABLED_ACTIVE),
+		};
+
+		static constexpr char sm_szBetween[] = ". ";
+		static constexpr char sm_szEnds[] = "\n";
+		static constexpr char sm_szEndsAndStartsWith[] = "\n\n";
+
+		CLayerWriter(CBufferStringText *const *ppLayers, int nLayers, int nCapacity, LayerMask_t nWrittenLayers = MENU_LAYER_ALL);
+
+		void AppendEnds(LayerMask_t nLayers = MENU_LAYER_ALL);
+		void AppendEndsAndStartsWith(LayerMask_t nLayers = MENU_LAYER_ALL);
+		void AppendLine(LayerMask_t nLineLayers, const char *pszNumber, const char *pszContent, int nContentLength = -1); // The rest of layers get an empty line.
+
+	protected:
+		void Write(int iLayer, const char *pszText, int nLength);
+		LayerMask_t MergeLayers(LayerMask_t nLineLayers) const; // The disabled active lines go to the inactive layer when it is not written.
+
+	private:
+		CBufferStringText *const *m_ppLayers;
+		int m_nLayers;
+		LayerMask_t m_nWrittenLayers; // Of the profile, the rest are left empty.
+		int m_nCapacity;
+		int m_arrLengths[MENU_MAX_ENTITIES];
+	};
+
+	// Bump storage of the rendered texts, exactly sized and reset as a whole.
+	class CPageArena
+	{
+	public:
+		static constexpr int sm_nBlockSize = MENU_MAX_ENTITIES * MENU_MAX_TEXT_LENGTH; // Fits a full page.
+
+		CPageArena();
+		~CPageArena();
+
+		const char *Store(const char *pszText, int nLength); // Copies the text with a null terminator.
+		void Reset(); // Keeps the blocks for the next pages.
+		void Purge();
+		void Swap(CPageArena &aOther);
+
+		uintp GetUsedBytes() const
+		{
+			return m_nUsedBytes;
+		}
+
+	private:
+		CUtlVector<char *> m_vecBlocks;
+		int m_iCurrentBlock;
+		int m_nBlockUsed;
+		uintp m_nUsedBytes;
+	};
+
+	struct PageBounds_t
+	{
+		ItemPosition_t m_iStartItem;
+		ItemPosition_t m_iEndItem; // The next page start or the items count.
+		bool m_bHasBack;
+		bool m_bHasNext;
+
+		const Items_t *m_pItems = nullptr; // Of the page only, from the start item. Otherwise the menu items.
+	};
+
+	// Start items of the pages by their numbers, skipping hidden (empty) items.
+	class CPageIndex
+	{
+	public:
+		void Build(const Items_t &vecItems, uint8 nMaxItems, ItemPosition_t iFromItem = MENU_FIRST_ITEM_INDEX); // Keeps the pages before the item.
+		void BuildUniform(ItemPosition_t nItems, uint8 nMaxItems); // Every page is full, by the count only.
+
+		int Count() const
+		{
+			return m_bUniform ? MAX((m_nItems + m_nMaxItems - 1) / m_nMaxItems, 1) : m_vecStartItems.Count();
+		}
+
+		uint8 GetMaxItems() const
+		{
+			return m_nMaxItems;
+		}
+
+		ItemPosition_t GetStartItem(int iPage) const
+		{
+			return m_bUniform ? iPage * m_nMaxItems : m_vecStartItems[iPage];
+		}
+
+		ItemPosition_t GetEndItem(int iPage) const
+		{
+			return iPage + 1 < Count() ? GetStartItem(iPage + 1) : m_nItems;
+		}
+
+		PageBounds_t GetBounds(int iPage) const
+		{
+			return {GetStartItem(iPage), GetEndItem(iPage), iPage > 0, iPage + 1 < Count()};
+		}
+
+		bool HasItem(int iPage, ItemPosition_t iItem) const
+		{
+			return 0 <= iPage && iPage < Count() && GetStartItem(iPage) <= iItem && iItem < GetEndItem(iPage);
+		}
+
+		int FindPage(ItemPosition_t iItem) const; // Clamped to the first and the last pages.
+
+	private:
+		CUtlVector<ItemPosition_t> m_vecStartItems; // Empty when uniform.
+		ItemPosition_t m_nItems = 0;
+		uint8 m_nMaxItems = 0;
+		bool m_bUniform = false;
+	};
+
 	class IPage
 	{
 	public:
@@ -176,7 +401,9 @@ public: // IMenu
 		virtual const char *GetDisabledActiveText() const = 0;
 		virtual void Clear() = 0;
 
-		virtual void Render(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, ItemPosition_t iStartPosition, uint8 nMaxItems) = 0; // Render a page.
+		virtual void Render(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, const PageBounds_t &aBounds, CPageArena &aArena) = 0; // Render a page, the texts are stored to the arena.
+		virtual int GetTextBytes() const = 0; // Stored to the arena.
+		virtual void MoveTexts(CPageArena &aArena) = 0; // Stores the texts to another arena.
 	};
 
 	class CPageBase : public IPage
@@ -187,17 +414,17 @@ public: // IMenu
 		// IPage
 		bool IsEmpty() const override
 		{
-			return m_sText.Length() == 0;
+			return m_nTextLength == 0;
 		}
 
 		const char *GetText() const override
 		{
-			return m_sText.Get();
+			return m_pszText;
 		}
 
 		const char *GetInactiveText() const override
 		{
-			return m_sText.Get();
+			return m_pszText;
 		}
 
 		const char *GetActiveText() const override
@@ -212,22 +439,50 @@ public: // IMenu
 
 		void Clear() override
 		{
-			m_sText.Clear();
+			m_pszText = "";
+			m_nTextLength = 0;
+			m_nTextBytes = 0;
+		}
+
+		void Render(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, const PageBounds_t &aBounds, CPageArena &aArena) override; // Dispatches to RenderAs().
+
+		int GetTextBytes() const override
+		{
+			return m_nTextBytes;
+		}
+
+		void MoveTexts(CPageArena &aArena) override;
+
+	public: // Render variants.
+		static constexpr int sm_nRenderHandlerBit = (1 << 3); // Over the control flags.
+		static constexpr int sm_nRenderVariants = (sm_nRenderHandlerBit << 1);
+
+		static int GetRenderVariant(IMenu *pMenu, const CMenuData_t &aData)
+		{
+			return (aData.m_eControlFlags & MENU_ITEM_CONTROL_DEFAULT_FLAGS) | (pMenu->GetHandler() ? sm_nRenderHandlerBit : 0);
 		}
 
-		void Render(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, ItemPosition_t iStartPosition, uint8 nMaxItems) override;
+		// Resolves the control and the handler checks at compile time.
+		template<ItemControlFlags_t CONTROLS, bool HAS_HANDLER>
+		void RenderAs(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, const PageBounds_t &aBounds, CPageArena &aArena);
 
 	protected:
-		CBufferStringText m_sText;
+		static CBufferStringText *const *GetRenderLayers(); // Scratch to render into, by MenuEntity_t.
+
+	protected:
+		const char *m_pszText; // Into the arena.
+		int m_nTextLength;
+		int m_nTextBytes; // Of all layers.
+		int m_nTextSize;
 	};
 
 	class CPage : public CPageBase
 	{
 	public:
 		using Base = CPageBase;
-		using Base::m_sText;
+		using Base::m_pszText;
 
-		CPage(int nTextSize = MENU_MAX_TEXT_LENGTH);
+		CPage(int nTextSize = MENU_MAX_TEXT_LENGTH, CLayerWriter::LayerMask_t nLayers = CLayerWriter::MENU_LAYER_ALL);
 
 	public: // Page additional methods
 		const char *GetBackgroundText() const
@@ -238,36 +493,228 @@ public: // IMenu
 	public: // IPage
 		const char *GetInactiveText() const override
 		{
-			return m_sInactiveText.Get();
+			return m_pszInactiveText;
 		}
 
 		virtual const char *GetActiveText() const override
 		{
-			return m_sActiveText.Get();
+			return m_pszActiveText;
 		}
 
 		const char *GetDisabledActiveText() const override
 		{
-			return m_sDisabledActiveText.Get();
+			return m_pszDisabledActiveText;
 		}
 
 		void Clear() override
 		{
 			Base::Clear();
 
-			m_sInactiveText.Clear();
-			m_sActiveText.Clear();
-			m_sDisabledActiveText.Clear();
+			m_pszInactiveText = "";
+			m_pszActiveText = "";
+			m_pszDisabledActiveText = "";
+		}
+
+		void Render(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, const PageBounds_t &aBounds, CPageArena &aArena) override; // Dispatches to RenderAs().
+		void MoveTexts(CPageArena &aArena) override;
+
+	public: // Render variants.
+		template<ItemControlFlags_t CONTROLS, bool HAS_HANDLER>
+		void RenderAs(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, const PageBounds_t &aBounds, CPageArena &aArena);
+
+	private: // Into the arena.
+		const char *m_pszInactiveText;
+		const char *m_pszActiveText;
+		const char *m_pszDisabledActiveText;
+
+		CLayerWriter::LayerMask_t m_nLayers; // To render, see CMenu::GetLayerMask().
+	};
+
+	// Pages shared by the players who see the same content.
+	class CPageCache
+	{
+	public:
+		using ILanguage = ISample::ILanguage;
+
+		struct Key_t
+		{
+			uint32 m_nContentVersion;
+			ItemPosition_t m_iStartItem;
+			const ILanguage *m_pLanguage; // Control items are translated to the player language.
+			ItemControlFlags_t m_eControlFlags;
+			bool m_bIsBase;
+			int m_iSlot; // Of a slot specific page, otherwise -1.
+			CLayerWriter::LayerMask_t m_nLayers; // Instances of other profiles may share the page.
+
+			static bool Less(const Key_t &aLeft, const Key_t &aRight)
+			{
+				if(aLeft.m_nContentVersion != aRight.m_nContentVersion)
+				{
+					return aLeft.m_nContentVersion < aRight.m_nContentVersion;
+				}
+
+				if(aLeft.m_iStartItem != aRight.m_iStartItem)
+				{
+					return aLeft.m_iStartItem < aRight.m_iStartItem;
+				}
+
+				if(aLeft.m_pLanguage != aRight.m_pLanguage)
+				{
+					return aLeft.m_pLanguage < aRight.m_pLanguage;
+				}
+
+				if(aLeft.m_eControlFlags != aRight.m_eControlFlags)
+				{
+					return aLeft.m_eControlFlags < aRight.m_eControlFlags;
+				}
+
+				if(aLeft.m_iSlot != aRight.m_iSlot)
+				{
+					return aLeft.m_iSlot < aRight.m_iSlot;
+				}
+
+				if(aLeft.m_nLayers != aRight.m_nLayers)
+				{
+					return aLeft.m_nLayers < aRight.m_nLayers;
+				}
+
+				return aLeft.m_bIsBase < aRight.m_bIsBase;
+			}
+		};
+
+		// A cached page, linked into the recently used ones of all menus.
+		struct Entry_t
+		{
+			Key_t m_aKey;
+			IPage *m_pPage;
+			CPageCache *m_pCache;
+			uintp m_nBytes;
+
+			Entry_t *m_pPrev;
+			Entry_t *m_pNext;
+
+			bool m_bPrerendered; // Ahead of a display, until the first hit.
+		};
+
+		CPageCache();
+		~CPageCache();
+
+		IPage *Find(const Key_t &aKey); // Counts a hit or a miss.
+		void Insert(const Key_t &aKey, IPage *pPage, bool bPrerendered = false); // Evicts the least recently used pages over the budget.
+
+		bool HasPage(const Key_t &aKey) const // Without counting.
+		{
+			return m_mapPages.Find(aKey) != m_mapPages.InvalidIndex();
+		}
+		void Remove(const Key_t &aKey);
+		bool Drop(const Key_t &aKey); // Removes without compacting, see CPageBudget::Evict().
+		void Compact(); // Moves the live texts to a new arena.
+
+		template<class PRED>
+		void RemoveIf(PRED funcPred) // By key.
+		{
+			FOR_EACH_MAP_FAST(m_mapPages, i)
+			{
+				if(funcPred(m_mapPages.Key(i)))
+				{
+					DeleteAt(i);
+				}
+			}
+
+			CompactIfSparse();
+		}
+
+		void RemoveAll(); // Deletes the pages with their texts, keeping the memory.
+		void Purge();
+
+		int Count() const
+		{
+			return m_mapPages.Count();
+		}
+
+		CPageArena &GetArena()
+		{
+			return m_aArena;
+		}
+
+	protected:
+		void DeleteAt(int iElement);
+		void CompactIfSparse(); // Moves the live texts to a new arena, once the removed ones take most of it.
+
+	private:
+		CUtlMap<Key_t, Entry_t *> m_mapPages;
+		CPageArena m_aArena; // Texts of the pages.
+		uintp m_nTextBytes; // Of the live pages.
+	};
+
+	// Bounds the bytes of the cached pages of all menus, evicting the least recently used ones.
+	class CPageBudget
+	{
+	public:
+		using Entry_t = CPageCache::Entry_t;
+
+		struct Stats_t
+		{
+			uint64 m_nHits = 0;
+			uint64 m_nMisses = 0;
+			uint64 m_nEvictions = 0;
+			uintp m_nBytes = 0;
+			uintp m_nLimit = 0; // Unlimited.
+			int m_nPages = 0;
+
+			uint64 m_nPrerenders = 0;
+			uint64 m_nPrerenderHits = 0; // Displayed after.
+			uint64 m_nPrerenderDeferrals = 0; // Frames out of the time budget.
+		};
+
+		void SetLimit(uintp nBytes)
+		{
+			m_aStats.m_nLimit = nBytes;
+		}
+
+		const Stats_t &GetStats() const
+		{
+			return m_aStats;
+		}
+
+		void CountHit()
+		{
+			m_aStats.m_nHits++;
+		}
+
+		void CountMiss()
+		{
+			m_aStats.m_nMisses++;
+		}
+
+		void CountPrerender()
+		{
+			m_aStats.m_nPrerenders++;
+		}
+
+		void CountPrerenderHit()
+		{
+			m_aStats.m_nPrerenderHits++;
 		}
 
-		void Render(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, ItemPosition_t iStartPosition, uint8 nMaxItems) override;
+		void CountPrerenderDeferral()
+		{
+			m_aStats.m_nPrerenderDeferrals++;
+		}
+
+		void Link(Entry_t *pEntry); // As the most recent.
+		void Unlink(Entry_t *pEntry);
+		void Touch(Entry_t *pEntry);
+		void Evict(const Entry_t *pKeep); // Down to the limit, compacting the arenas evicted from.
 
 	private:
-		CBufferStringText m_sInactiveText;
-		CBufferStringText m_sActiveText;
-		CBufferStringText m_sDisabledActiveText;
+		Entry_t *m_pHead = nullptr; // The most recent.
+		Entry_t *m_pTail = nullptr;
+		Stats_t m_aStats;
 	};
 
+	static CPageBudget &GetPageBudget(); // Of all menus.
+
 	static constexpr uint8 sm_nMaxItemsPerPage = MENU_DEFAULT_ITEMS_COUNT_PER_PAGE;
 	uint8 GetMaxItemsPerPageWithoutControls();
 
@@ -276,62 +723,149 @@ public: // IMenu
 
 	virtual bool OnSelect(CPlayerSlot aSlot, int iSelectedItem, DisplayFlags_t eFlags = MENU_DISPLAY_DEFAULT);
 
+	bool HasItemChanges() const
+	{
+		return m_iChangedFirst != MENU_INVALID_ITEM_POSITION || m_bViewersChanged;
+	}
+
+	int FlushItemChanges(); // Re-renders the changed pages for the viewers on them. Returns a number of the viewers.
+	bool PrerenderAdjacentPage(CPlayerSlot aSlot, int iOffset); // Renders the page next to the viewer one to the cache, ahead of "Back" or "Next". Returns false if there is nothing to render.
+
 public: // Internal methods.
 	CEntityKeyValues *GetAllocatedBackgroundKeyValues(CPlayerSlot aSlot, CKeyValues3Context *pAllocator = nullptr); // Must be deleted.
 	CEntityKeyValues *GetAllocatedInactiveKeyValues(CPlayerSlot aSlot, CKeyValues3Context *pAllocator = nullptr, bool bDrawBackground = true); // Must be deleted.
 	CEntityKeyValues *GetAllocatedActiveKeyValues(CPlayerSlot aSlot, CKeyValues3Context *pAllocator = nullptr, bool bDrawBackground = true); // Must be deleted.
 	CEntityKeyValues *GetAllocatedDisabledActiveKeyValues(CPlayerSlot aSlot, CKeyValues3Context *pAllocator = nullptr, bool bDrawBackground = true); // Must be deleted.
-	CUtlVector<CEntityKeyValues *> GenerateKeyValues(CPlayerSlot aSlot, CKeyValues3Context *pAllocator = nullptr, bool bIncludeBackground = true); // Must be closed with `PurgeAndDeleteElements()`.
+	CUtlVector<CEntityKeyValues *> GenerateKeyValues(CPlayerSlot aSlot, CKeyValues3Context *pAllocator = nullptr, bool bIncludeBackground = true); // Must be closed with `PurgeAndDeleteElements()`. One by a spawned layer.
+	CLayerWriter::LayerMask_t GetLayerMask() const; // The spawned layers by the profile, an entity by each in MenuEntity_t order.
+	static const char *GetPageLayerText(const IPage *pPage, MenuEntity_t eLayer);
 	static Color CalculatePassiveColor(const Color &rgbaActive, const Color &rgbaInactive);
 
 protected:
+	CEntityInstance *GetLayerEntity(MenuEntity_t eLayer) const; // nullptr if the profile does not spawn the layer.
+
 	CEntityInstance *GetBackgroundEntity()
 	{
-		return GetActiveEntities()[MENU_ENTITY_BACKGROUND_INDEX];
+		return GetLayerEntity(MENU_ENTITY_BACKGROUND_INDEX);
 	}
 
 	CEntityInstance *GetInactiveEntity()
 	{
-		return GetActiveEntities()[MENU_ENTITY_INACTIVE_INDEX];
+		return GetLayerEntity(MENU_ENTITY_INACTIVE_INDEX);
 	}
 
 	CEntityInstance *GetActiveEntity()
 	{
-		return GetActiveEntities()[MENU_ENTITY_ACTIVE_INDEX];
+		return GetLayerEntity(MENU_ENTITY_ACTIVE_INDEX);
+	}
+
+	// Forgets the texts sent to the entities, once they are taken from or returned to the pool.
+	void ResetSentTexts()
+	{
+		m_arrSentTexts.fill({});
 	}
 
 protected:
-	void InternalSetMessage(MenuEntity_t eEntity, const char *pszText);
+	void InternalSetMessage(int iEntity, const char *pszText); // By the spawned order, see GetLayerMask().
+
+	ViewerState_t *FindOrAddViewer(CPlayerSlot aSlot);
 
-	const IPage *GetCurrentPage(CPlayerSlot aSlot, bool bIsBase = false)
+	uint32 GetContentVersion() const
 	{
-		auto &mapCachedPages = (bIsBase ? m_arrCachedPageBasesMap : m_arrCachedPagesMap)[aSlot.GetClientIndex()];
+		return m_nContentVersion;
+	}
+
+	void MarkContentChanged(); // Invalidates the shared pages.
 
-		auto iFound = mapCachedPages.Find(GetCurrentPosition(aSlot));
+	void ApplyItemChanges(); // Marks the viewers on the changed pages and removes those pages from the cache.
 
-		return iFound == mapCachedPages.InvalidIndex() ? nullptr : static_cast<IPage *>(mapCachedPages.Element(iFound));
+	// A page covers the next page start too, which enables its "Next" control.
+	static bool IsPageChanged(const PageBounds_t &aBounds, ItemPosition_t iFirst, ItemPosition_t iLast)
+	{
+		return aBounds.m_iStartItem <= iLast && aBounds.m_iEndItem >= iFirst;
+	}
+
+	const CPageIndex &GetPageIndex(); // Builds it for the current items.
+	int FindPageNumber(const ViewerState_t *pViewer, ItemPosition_t iItem); // Checks the viewer page and the next to it first.
+
+	bool IsRenderSlotSpecific(CPlayerSlot aSlot);
+	CPageCache &FindPageCache(bool bSlotSpecific); // The template one when it is shared.
+	const Items_t &LoadPageItems(PageBounds_t &aBounds, Items_t &vecStorage); // Gets the items of a source page to the storage.
+	CPageCache::Key_t MakePageKey(CPlayerSlot aSlot, ItemPosition_t iStartItem, bool bIsBase, bool bSlotSpecific) const;
+
+	IPage *RenderPage(CPlayerSlot aSlot, int iPage, bool bIsBase, bool bRerender = false); // Finds a cached one first.
+	IPage *RenderNewPage(CPlayerSlot aSlot, PageBounds_t aBounds, bool bIsBase, CPageCache &aPageCache, const CPageCache::Key_t &aKey, bool bPrerendered = false); // Inserts to the cache.
+
+	const IPage *GetCurrentPage(CPlayerSlot aSlot, bool bIsBase = false) // Renders again when the page has been removed.
+	{
+		const auto *pViewer = FindViewer(aSlot);
+
+		return pViewer && pViewer->m_iCurrentPosition >= 0 ? RenderPage(aSlot, FindPageNumber(pViewer, pViewer->m_iCurrentPosition), bIsBase) : nullptr;
 	}
 
 private: // IMenuInstance fields.
 	const CPointWorldText_Helper *m_pSchemaHelper_PointWorldText;
 	const CGameData_BaseEntity *m_pGameData_BaseEntity;
+	ISample *m_pSample;
 	IMenuProfile *m_pProfile;
 	IMenuHandler *m_pHandler;
+	IMenuHandler *m_pNextHandler;
 	CPlayerBitVec m_bvPlayers;
 
 private: // IMenu fields.
 	CMenuData_t m_aData;
 
-protected: // Pages fields.
-	template<class T>
-	using ItemPages_t = CUtlMap<ItemPosition_t, IPage *>; 
+	CMenuTemplate *m_pTemplate;
+	bool m_bTemplateDetached;
+	bool m_bSharePages;
+
+	IItemSource *m_pItemSource; // Replaces the items.
+
+	uint32 m_nContentVersion;
+	CPageCache m_aPageCache;
+
+	ItemPosition_t m_iChangedFirst; // Or MENU_INVALID_ITEM_POSITION.
+	ItemPosition_t m_iChangedLast;
+	bool m_bViewersChanged; // Some viewers wait for FlushItemChanges().
 
-	 // By client indexes.
-	std::array<ItemPosition_t, ABSOLUTE_PLAYER_LIMIT + 1> m_arrCurrentPositions;
-	std::array<ItemPages_t<IPage>, ABSOLUTE_PLAYER_LIMIT + 1> m_arrCachedPageBasesMap;
-	std::array<ItemPages_t<IPage>, ABSOLUTE_PLAYER_LIMIT + 1> m_arrCachedPagesMap;
+	CPageIndex m_aPageIndex;
+	ItemPosition_t m_iPageIndexOutdatedFrom; // Or MENU_INVALID_ITEM_POSITION.
+
+public: // Pages fields.
+	// Allocated only for the players who see the menu.
+	struct ViewerState_t
+	{
+		ViewerState_t(CPlayerSlot aSlot)
+		 :  m_aSlot(aSlot), 
+		    m_iCurrentPosition(-1), 
+		    m_iCurrentPage(-1), 
+		    m_eLastDisplayFlags(MENU_DISPLAY_DEFAULT), 
+		    m_bItemsChanged(false)
+		{
+		}
+
+		CPlayerSlot m_aSlot;
+		ItemPosition_t m_iCurrentPosition;
+		int m_iCurrentPage; // A hint, by the page index.
+		DisplayFlags_t m_eLastDisplayFlags;
+		bool m_bItemsChanged; // The page is re-displayed by the next FlushItemChanges().
+	};
+
+protected:
+	CUtlVector<ViewerState_t *> m_vecViewers;
+	std::array<int8, ABSOLUTE_PLAYER_LIMIT + 1> m_arrViewerIndices; // By client indexes, into the viewers.
 
 	CPage *m_pCurrentPage = nullptr;
+
+	// The last text of each menu entity, by the spawned order.
+	struct SentText_t
+	{
+		const CEntityInstance *m_pEntity = nullptr; // Another one has not got the text yet.
+		uint32 m_nHash = 0;
+		int m_nLength = -1;
+	};
+
+	std::array<SentText_t, MENU_MAX_ENTITIES> m_arrSentTexts {};
 }; // Menu
 
 #endif // _INCLUDE_METAMOD_SOURCE_MENU_HPP_
@@ -102,6 +102,7 @@ namespace Menu
 		Color *m_pDisabledActiveColor = nullptr; // "disabled_active_color"
 
 		float m_flBackgroundAwayUnits = 0.f; // "background_away_units"
+		int m_nLayers = 0; // "layers"
 
 		using ResourcesBase_t = CUtlVector<CUtlString>;
 
@@ -124,6 +125,11 @@ namespace Menu
 
 		Resources_t m_vecResources;
 		CEntityKeyValues *m_pData = nullptr; // Other elements.
+
+		// Merged with the baseline ones at load, to copy once per spawn.
+		CEntityKeyValues *m_pFlattenedData = nullptr;
+		CEntityKeyValues *m_pFlattenedDataWithoutBackground = nullptr;
+		int m_nFlattenedLayers = 0;
 	};
 
 	enum ProfileLoadFlags_t : uint8
@@ -146,6 +152,7 @@ namespace Menu
 
 	public:
 		bool Load(CProfileSystem *pSystem, KeyValues3 *pData, ProfileLoadFlags_t eFlags, CUtlVector<CUtlString> &vecMessages);
+		void FlattenEntityKeyValues(CProfileSystem *pSystem); // Once the bases are loaded.
 
 	protected:
 		void LoadMetadataBase(CProfileSystem *pSystem, KeyValues3 *pData, CUtlVector<CUtlString> &vecMessages);
@@ -155,6 +162,8 @@ namespace Menu
 		static Items_t *LoadAllocatedItems(KeyValues3 *pData, CUtlVector<CUtlString> &vecMessages);
 		static IMenuProfile::MatrixOffset_t *LoadAllocatedMatrixOffset(KeyValues3 *pData, CUtlVector<CUtlString> &vecMessages);
 		static CEntityKeyValues *LoadAllocatedEntityKeyValues(CProfileSystem *pSystem, KeyValues3 *pData, CUtlVector<CUtlString> &vecMessages);
+		CEntityKeyValues *MergeAllocatedEntityKeyValues(CKeyValues3Context *pAllocator, bool bIncludeBackground) const; // Walks the baseline.
+		int MergeLayers() const; // Walks the baseline.
 
 	protected:
 		static void RemoveStaticMembers(KeyValues3 *pData);
@@ -174,6 +183,7 @@ namespace Menu
 		float GetBackgroundAwayUnits() const override;
 		CUtlVector<const char *> GetResources() const override;
 		CEntityKeyValues *GetAllocactedEntityKeyValues(CKeyValues3Context *pAllocator = nullptr, bool bIncludeBackground = true) const override;
+		int GetLayers() const override;
 	};
 };
 
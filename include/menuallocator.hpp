@@ -34,20 +34,55 @@
 #	include <tier1/utlvector.h>
 
 #	define MENU_MEMBLOCK_RESERVED_FREE_BIT (1 << 30)
-#	define MENU_MEMBLOCK_RESERVED_INSTANCE_THISOFFSET_MASK (~MENU_MEMBLOCK_RESERVED_FREE_BIT)
+#	define MENU_MEMBLOCK_RESERVED_CONSTRUCTED_BIT (1 << 29)
+#	define MENU_MEMBLOCK_RESERVED_CLOSING_BIT (1 << 28)
+#	define MENU_MEMBLOCK_HEADER_ALIGN 16
+#	define MENU_MEMBLOCK_INVALID_INDEX -1
 
 class IMenuProfile;
 
-template<uintp PAGE_SIZE = sizeof(CMenu)>
+template<uintp INSTANCE_SIZE = sizeof(CMenu)>
 class CMenuAllocator
 {
 public:
 	using CInstance_t = CMenu;
 	using Interface_t = IMenu;
+	using Handle_t = IMenu::Handle_t;
+
+	// Stored in front of each instance to resolve its memory block in constant time.
+	struct BlockHeader_t
+	{
+		int m_iMemBlock;
+	};
+
+	static constexpr uintp sm_nHeaderSize = ALIGN_VALUE(sizeof(BlockHeader_t), MENU_MEMBLOCK_HEADER_ALIGN);
+	static constexpr uintp sm_nBlockSize = sm_nHeaderSize + INSTANCE_SIZE;
+
+	struct Stats_t
+	{
+		int m_nLive;
+		int m_nFree;
+		int m_nHighWaterMark;
+		uintp m_nBytes;
+
+		int m_nWarm;
+		int m_nWarmLimit;
+		int m_nPoolHits;
+		int m_nPoolMisses;
+	};
 
 	CMenuAllocator(int nGrowSize = 0, int nInitSize = 16, RawAllocatorType_t eAllocatorType = RawAllocator_Standard)
 	 :  m_vecMemBlocks(nInitSize, nGrowSize),
-	    m_MemBlockAllocator((nInitSize > 0) ? ABSOLUTE_PLAYER_LIMIT : 0, PAGE_SIZE, eAllocatorType)
+	    m_MemBlockAllocator((nInitSize > 0) ? ABSOLUTE_PLAYER_LIMIT : 0, sm_nBlockSize, eAllocatorType), 
+	    m_iFirstFree(MENU_MEMBLOCK_INVALID_INDEX), 
+	    m_iFirstWarm(MENU_MEMBLOCK_INVALID_INDEX), 
+	    m_nFirstGeneration(1), 
+	    m_nLiveCount(0), 
+	    m_nHighWaterMark(0), 
+	    m_nWarmCount(0), 
+	    m_nWarmLimit(0), 
+	    m_nPoolHits(0), 
+	    m_nPoolMisses(0)
 	{
 	}
 
@@ -55,10 +90,14 @@ public:
 	struct MemBlock_t
 	{
 		int m_nReserved;
+		int m_iNextFree; // Intrusive free list link, valid while the block is free.
+		uint32 m_nGeneration; // Bumped on each release to reject stale handles. Never 0.
 		MemBlockHandle_t m_Handle;
 
-		MemBlock_t(const MemBlockHandle_t &hBlock)
+		MemBlock_t(const MemBlockHandle_t &hBlock, uint32 nGeneration = 1)
 		 :  m_nReserved(0), 
+		    m_iNextFree(MENU_MEMBLOCK_INVALID_INDEX), 
+		    m_nGeneration(nGeneration), 
 		    m_Handle(hBlock)
 		{
 		}
@@ -68,9 +107,14 @@ public:
 			return !!(m_nReserved & MENU_MEMBLOCK_RESERVED_FREE_BIT);
 		}
 
-		int GetInstanceThisOffset() const
+		bool IsClosing() const
 		{
-			return m_nReserved & MENU_MEMBLOCK_RESERVED_INSTANCE_THISOFFSET_MASK;
+			return !!(m_nReserved & MENU_MEMBLOCK_RESERVED_CLOSING_BIT);
+		}
+
+		bool IsAlive() const
+		{
+			return !(m_nReserved & (MENU_MEMBLOCK_RESERVED_FREE_BIT | MENU_MEMBLOCK_RESERVED_CLOSING_BIT));
 		}
 
 		MemBlockHandle_t GetHandle() const
@@ -93,9 +137,39 @@ public:
 			m_nReserved |= MENU_MEMBLOCK_RESERVED_FREE_BIT;
 		}
 
-		void SetThisOffset(CInstance_t *pInstance)
+		void NextGeneration()
+		{
+			if(!++m_nGeneration)
+			{
+				m_nGeneration = 1;
+			}
+		}
+
+		void MarkUsed()
+		{
+			m_nReserved &= ~(MENU_MEMBLOCK_RESERVED_FREE_BIT | MENU_MEMBLOCK_RESERVED_CLOSING_BIT);
+		}
+
+		// Still constructed until the close queue is flushed, but no longer reachable by handles.
+		void MarkClosing()
+		{
+			m_nReserved |= MENU_MEMBLOCK_RESERVED_CLOSING_BIT;
+			NextGeneration();
+		}
+
+		bool IsConstructed() const
+		{
+			return !!(m_nReserved & MENU_MEMBLOCK_RESERVED_CONSTRUCTED_BIT);
+		}
+
+		void MarkConstructed()
+		{
+			m_nReserved |= MENU_MEMBLOCK_RESERVED_CONSTRUCTED_BIT;
+		}
+
+		void MarkDestructed()
 		{
-			m_nReserved = reinterpret_cast<uintp>(static_cast<Interface_t *>(pInstance)) - reinterpret_cast<uintp>(pInstance) & MENU_MEMBLOCK_RESERVED_INSTANCE_THISOFFSET_MASK;
+			m_nReserved &= ~MENU_MEMBLOCK_RESERVED_CONSTRUCTED_BIT;
 		}
 	};
 
@@ -105,65 +179,219 @@ public:
 		return reinterpret_cast<T *>(reinterpret_cast<uintp>(m_MemBlockAllocator.GetBlock(hMemBlock)) + nThisOffset);
 	}
 
+	inline BlockHeader_t *GetHeaderByMemBlock(const MemBlock_t *pMemBlock)
+	{
+		return GetByHandle<BlockHeader_t>(pMemBlock->GetHandle());
+	}
+
+	inline BlockHeader_t *GetHeaderByInstance(CInstance_t *pInstance)
+	{
+		return reinterpret_cast<BlockHeader_t *>(reinterpret_cast<uintp>(pInstance) - sm_nHeaderSize);
+	}
+
 	inline auto *GetInstanceByMemBlock(const MemBlock_t *pMemBlock)
 	{
-		return GetByHandle<CInstance_t>(pMemBlock->GetHandle(), pMemBlock->GetInstanceThisOffset());
+		return GetByHandle<CInstance_t>(pMemBlock->GetHandle(), sm_nHeaderSize);
 	}
 
-	MemBlock_t *FindLastFreeMemBlock()
+	// Free blocks are kept in two lists: warm ones still hold a constructed instance, the rest are raw memory.
+	MemBlock_t *PopFreeMemBlock(int &iFirst)
 	{
-		MemBlockHandle_t hBlock = MEMBLOCKHANDLE_INVALID;
+		if(iFirst == MENU_MEMBLOCK_INVALID_INDEX)
+		{
+			return nullptr;
+		}
 
-		FOR_EACH_VEC_BACK(m_vecMemBlocks, i)
+		auto &aMemBlock = m_vecMemBlocks[iFirst];
+
+		iFirst = aMemBlock.m_iNextFree;
+		aMemBlock.m_iNextFree = MENU_MEMBLOCK_INVALID_INDEX;
+
+		return &aMemBlock;
+	}
+
+	void PushFreeMemBlock(int &iFirst, MemBlock_t *pMemBlock)
+	{
+		pMemBlock->MarkFree();
+		pMemBlock->m_iNextFree = iFirst;
+		iFirst = GetMemBlockIndex(pMemBlock);
+	}
+
+	MemBlock_t *AllocMemBlock()
+	{
+		MemBlock_t *pMemBlock = PopFreeMemBlock(m_iFirstFree);
+
+		if(!pMemBlock)
 		{
-			auto &aElm = m_vecMemBlocks[i];
+			MemBlockHandle_t hMemBlock = m_MemBlockAllocator.Alloc(sm_nBlockSize);
 
-			if(aElm.IsFree())
+			if(hMemBlock == MEMBLOCKHANDLE_INVALID)
 			{
-				return &aElm;
+				return nullptr;
 			}
+
+			pMemBlock = &m_vecMemBlocks.Element(m_vecMemBlocks.AddToTail(MemBlock_t(hMemBlock, m_nFirstGeneration)));
 		}
 
-		return nullptr;
+		GetHeaderByMemBlock(pMemBlock)->m_iMemBlock = GetMemBlockIndex(pMemBlock);
+
+		return pMemBlock;
 	}
 
-	MemBlock_t *FindMemBlock(Interface_t *pMenu)
+	inline int GetMemBlockIndex(const MemBlock_t *pMemBlock) const
 	{
-		FOR_EACH_VEC_BACK(m_vecMemBlocks, i)
+		return static_cast<int>(pMemBlock - m_vecMemBlocks.Base());
+	}
+
+	// Constant time: reads the block header and checks it back against the block list.
+	// The header is read before the check, so pMenu must be a CInstance_t laid out with one: of this or another allocator, live or released while its memory is kept.
+	// Any other pointer (a foreign IMenu implementation, or one of a purged allocator) is undefined.
+	MemBlock_t *FindMemBlock(Interface_t *pMenu, bool bIncludeClosing = false)
+	{
+		if(!pMenu)
 		{
-			auto &aElm = m_vecMemBlocks[i];
+			return nullptr;
+		}
 
-			if((reinterpret_cast<uintp>(pMenu) + aElm.GetInstanceThisOffset()) == reinterpret_cast<uintp>(m_MemBlockAllocator.GetBlock(aElm.GetHandle())))
-			{
-				return &aElm;
-			}
+		auto *pInstance = static_cast<CInstance_t *>(pMenu);
+
+		Assert(!(reinterpret_cast<uintp>(pInstance) % alignof(CInstance_t))); // Not a CInstance_t, see above.
+
+		const BlockHeader_t *pHeader = GetHeaderByInstance(pInstance);
+
+		int iMemBlock = pHeader->m_iMemBlock;
+
+		if(!m_vecMemBlocks.IsValidIndex(iMemBlock))
+		{
+			return nullptr;
 		}
 
-		return nullptr;
+		auto &aMemBlock = m_vecMemBlocks[iMemBlock];
+
+		if(aMemBlock.IsFree() || (!bIncludeClosing && aMemBlock.IsClosing()) || GetHeaderByMemBlock(&aMemBlock) != pHeader)
+		{
+			return nullptr;
+		}
+
+		return &aMemBlock;
+	}
+
+	Handle_t GetHandleByMemBlock(const MemBlock_t *pMemBlock) const
+	{
+		return (static_cast<Handle_t>(pMemBlock->m_nGeneration) << 32) | static_cast<uint32>(GetMemBlockIndex(pMemBlock));
+	}
+
+	Handle_t FindHandle(Interface_t *pMenu)
+	{
+		MemBlock_t *pMemBlock = FindMemBlock(pMenu);
+
+		return pMemBlock ? GetHandleByMemBlock(pMemBlock) : MENU_INVALID_HANDLE;
+	}
+
+	// An index check and a generation compare.
+	MemBlock_t *FindMemBlockByHandle(Handle_t hMenu)
+	{
+		int iMemBlock = static_cast<int>(static_cast<uint32>(hMenu));
+
+		if(!m_vecMemBlocks.IsValidIndex(iMemBlock))
+		{
+			return nullptr;
+		}
+
+		auto &aMemBlock = m_vecMemBlocks[iMemBlock];
+
+		if(!aMemBlock.IsAlive() || aMemBlock.m_nGeneration != static_cast<uint32>(hMenu >> 32))
+		{
+			return nullptr;
+		}
+
+		return &aMemBlock;
+	}
+
+	CInstance_t *FindByHandle(Handle_t hMenu)
+	{
+		MemBlock_t *pMemBlock = FindMemBlockByHandle(hMenu);
+
+		return pMemBlock ? GetInstanceByMemBlock(pMemBlock) : nullptr;
 	}
 
 public:
-	CInstance_t *CreateInstance(const CMenu::CPointWorldText_Helper *pCtorSchemaHelper, const CMenu::CGameData_BaseEntity *pCtorGameData, IMenuProfile *pCtorProfile, IMenuHandler *pCtorHandler = nullptr, CMenuData_t::ControlItems_t *pCtorControls = nullptr)
+	CInstance_t *CreateInstance(const CMenu::CPointWorldText_Helper *pCtorSchemaHelper, const CMenu::CGameData_BaseEntity *pCtorGameData, ISample *pCtorSample, IMenuProfile *pCtorProfile, IMenuHandler *pCtorHandler = nullptr, CMenuData_t::ControlItems_t *pCtorControls = nullptr)
 	{
-		MemBlock_t *pMemBlock = FindLastFreeMemBlock();
+		CInstance_t *pResult;
 
-		MemBlockHandle_t hMemBlock {};
+		MemBlock_t *pMemBlock = PopFreeMemBlock(m_iFirstWarm);
 
 		if(pMemBlock)
 		{
-			hMemBlock = pMemBlock->GetHandle();
+			m_nWarmCount--;
+			m_nPoolHits++;
+
+			pResult = GetInstanceByMemBlock(pMemBlock);
+			pResult->Reset(pCtorProfile, pCtorHandler, pCtorControls);
 		}
 		else
 		{
-			hMemBlock = m_MemBlockAllocator.Alloc(sizeof(CInstance_t));
-			pMemBlock = &m_vecMemBlocks.Element(m_vecMemBlocks.AddToTail(MemBlock_t(hMemBlock)));
+			pMemBlock = AllocMemBlock();
+
+			if(!pMemBlock)
+			{
+				return nullptr;
+			}
+
+			m_nPoolMisses++;
+
+			pResult = Construct(GetInstanceByMemBlock(pMemBlock), pCtorSchemaHelper, pCtorGameData, pCtorSample, pCtorProfile, pCtorHandler, pCtorControls);
+			pMemBlock->MarkConstructed();
+		}
+
+		pMemBlock->MarkUsed();
+
+		if(++m_nLiveCount > m_nHighWaterMark)
+		{
+			m_nHighWaterMark = m_nLiveCount;
+		}
+
+		return pResult;
+	}
+
+	// Pre-constructs instances until the warm pool holds the limit.
+	int Prewarm(const CMenu::CPointWorldText_Helper *pCtorSchemaHelper, const CMenu::CGameData_BaseEntity *pCtorGameData, ISample *pCtorSample)
+	{
+		int nCreated = 0;
+
+		while(m_nWarmCount < m_nWarmLimit)
+		{
+			MemBlock_t *pMemBlock = AllocMemBlock();
+
+			if(!pMemBlock)
+			{
+				break;
+			}
+
+			Construct(GetInstanceByMemBlock(pMemBlock), pCtorSchemaHelper, pCtorGameData, pCtorSample, nullptr);
+			pMemBlock->MarkConstructed();
+			PushFreeMemBlock(m_iFirstWarm, pMemBlock);
+			m_nWarmCount++;
+			nCreated++;
 		}
 
-		auto *pResult = GetByHandle<CInstance_t>(hMemBlock);
+		return nCreated;
+	}
+
+	void SetWarmLimit(int nLimit)
+	{
+		m_nWarmLimit = nLimit;
 
-		pMemBlock->SetThisOffset(pResult);
+		while(m_nWarmCount > m_nWarmLimit)
+		{
+			MemBlock_t *pMemBlock = PopFreeMemBlock(m_iFirstWarm);
 
-		return pResult ? Construct(pResult, pCtorSchemaHelper, pCtorGameData, pCtorProfile, pCtorHandler, pCtorControls) : nullptr;
+			Destruct(GetInstanceByMemBlock(pMemBlock));
+			pMemBlock->MarkDestructed();
+			PushFreeMemBlock(m_iFirstFree, pMemBlock);
+			m_nWarmCount--;
+		}
 	}
 
 	CInstance_t *FindAndUpperCast(Interface_t *pMenu)
@@ -182,8 +410,22 @@ public:
 	{
 		auto *pInstance = GetInstanceByMemBlock(pMemBlock);
 
-		Destruct(pInstance);
-		pMemBlock->MarkFree();
+		pMemBlock->NextGeneration();
+
+		if(m_nWarmCount < m_nWarmLimit)
+		{
+			pInstance->Reset();
+			PushFreeMemBlock(m_iFirstWarm, pMemBlock);
+			m_nWarmCount++;
+		}
+		else
+		{
+			Destruct(pInstance);
+			pMemBlock->MarkDestructed();
+			PushFreeMemBlock(m_iFirstFree, pMemBlock);
+		}
+
+		m_nLiveCount--;
 	}
 
 	bool ReleaseByInterface(Interface_t *pMenu)
@@ -200,23 +442,101 @@ public:
 		return false;
 	}
 
+	// Returns the pages to the block allocator once nothing is alive.
+	// The block allocator has no per-block free, so with live menus the block memory is kept: 
+	// the warm instances past the last live block are destructed to free what they hold, 
+	// and the free lists are reordered to reuse the lowest blocks first and keep the tail free for the next compaction.
+	bool Compact()
+	{
+		if(!m_nLiveCount)
+		{
+			PurgeAndDeleteElements();
+
+			return true;
+		}
+
+		m_iFirstFree = MENU_MEMBLOCK_INVALID_INDEX;
+		m_iFirstWarm = MENU_MEMBLOCK_INVALID_INDEX;
+
+		bool bTail = true; // Past the last live block.
+
+		FOR_EACH_VEC_BACK(m_vecMemBlocks, i)
+		{
+			auto &aMemBlock = m_vecMemBlocks[i];
+
+			if(!aMemBlock.IsFree())
+			{
+				bTail = false;
+
+				continue;
+			}
+
+			if(bTail && aMemBlock.IsConstructed())
+			{
+				Destruct(GetInstanceByMemBlock(&aMemBlock));
+				aMemBlock.MarkDestructed();
+				m_nWarmCount--;
+			}
+
+			int &iFirst = aMemBlock.IsConstructed() ? m_iFirstWarm : m_iFirstFree;
+
+			aMemBlock.m_iNextFree = iFirst;
+			iFirst = i;
+		}
+
+		return false;
+	}
+
+	Stats_t GetStats() const
+	{
+		int nBlocks = m_vecMemBlocks.Count();
+
+		return {m_nLiveCount, nBlocks - m_nLiveCount, m_nHighWaterMark, static_cast<uintp>(nBlocks) * sm_nBlockSize, 
+		        m_nWarmCount, m_nWarmLimit, m_nPoolHits, m_nPoolMisses};
+	}
+
+	// Releases every live instance, refilling the warm pool first.
+	void ReleaseAll()
+	{
+		FOR_EACH_VEC(m_vecMemBlocks, i)
+		{
+			auto &aMemBlock = m_vecMemBlocks[i];
+
+			if(!aMemBlock.IsFree())
+			{
+				ReleaseByMemBlock(&aMemBlock);
+			}
+		}
+	}
+
 	void RemoveAll()
 	{
+		AdvanceFirstGeneration();
 		m_vecMemBlocks.RemoveAll();
 		m_MemBlockAllocator.RemoveAll();
+		m_iFirstFree = MENU_MEMBLOCK_INVALID_INDEX;
+		m_iFirstWarm = MENU_MEMBLOCK_INVALID_INDEX;
+		m_nLiveCount = 0;
+		m_nWarmCount = 0;
 	}
 
 	void Purge()
 	{
+		AdvanceFirstGeneration();
 		m_vecMemBlocks.Purge();
 		m_MemBlockAllocator.Purge();
+		m_iFirstFree = MENU_MEMBLOCK_INVALID_INDEX;
+		m_iFirstWarm = MENU_MEMBLOCK_INVALID_INDEX;
+		m_nLiveCount = 0;
+		m_nWarmCount = 0;
 	}
 
+	// Destructs live and warm instances.
 	void PurgeAndDeleteElements()
 	{
 		for(const auto &aMemBlock : m_vecMemBlocks)
 		{
-			if(aMemBlock.IsFree())
+			if(!aMemBlock.IsConstructed())
 			{
 				continue;
 			}
@@ -224,8 +544,27 @@ public:
 			Destruct(GetInstanceByMemBlock(&aMemBlock));
 		}
 
-		m_vecMemBlocks.Purge();
-		m_MemBlockAllocator.Purge();
+		Purge();
+	}
+
+private:
+	// New blocks start past every generation handed out, so handles of the removed blocks stay stale.
+	void AdvanceFirstGeneration()
+	{
+		uint32 nLastGeneration = m_nFirstGeneration;
+
+		for(const auto &aMemBlock : m_vecMemBlocks)
+		{
+			if(aMemBlock.m_nGeneration > nLastGeneration)
+			{
+				nLastGeneration = aMemBlock.m_nGeneration;
+			}
+		}
+
+		if(!(m_nFirstGeneration = nLastGeneration + 1))
+		{
+			m_nFirstGeneration = 1;
+		}
 	}
 
 private:
@@ -233,6 +572,17 @@ private:
 
 	MemBlocksVec_t m_vecMemBlocks;
 	CUtlMemoryBlockAllocator<CInstance_t> m_MemBlockAllocator;
+
+	int m_iFirstFree;
+	int m_iFirstWarm;
+	uint32 m_nFirstGeneration; // Of new blocks, survives Compact() and Purge().
+	int m_nLiveCount;
+	int m_nHighWaterMark;
+
+	int m_nWarmCount;
+	int m_nWarmLimit;
+	int m_nPoolHits;
+	int m_nPoolMisses;
 };
 
 #endif // _INCLUDE_METAMOD_SOURCE_MENUALLOCATOR_HPP_
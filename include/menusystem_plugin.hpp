@@ -29,6 +29,7 @@
 #	include "ientitymgr.hpp"
 #	include "menu.hpp"
 #	include "menuallocator.hpp"
+#	include "menutemplate.hpp"
 #	include "menu/chatsystem.hpp"
 #	include "menu/gameeventmanager2system.hpp"
 #	include "menu/pathresolver.hpp"
@@ -237,7 +238,7 @@ public: // IMenuSystem
 		virtual void OnLanguageChanged(CPlayerSlot aSlot, CLanguage *pData);
 
 	public: // Menu callbacks.
-		virtual bool OnMenuDisplayItem(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iItem, IMenu::Item_t &aData);
+		virtual bool OnMenuDisplayItem(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iItem, IMenu::ItemView_t &aView);
 		virtual bool OnMenuSwitch(CPlayerSlot aSlot);
 
 	public:
@@ -312,15 +313,46 @@ public: // IMenuSystem
 	IMenu *CreateInstance(IMenuProfile *pProfile, IMenuHandler *pHandler = nullptr) override;
 	bool DisplayInstanceToPlayer(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iStartItem = MENU_FIRST_ITEM_INDEX, int nManyTimes = MENU_TIME_FOREVER) override;
 	bool CloseInstance(IMenu *pMenu) override;
+	bool CloseInstanceNow(IMenu *pMenu) override;
+	IMenu::Handle_t GetInstanceHandle(IMenu *pMenu) override;
+	IMenu *FindInstanceByHandle(IMenu::Handle_t hMenu) override;
+	IMenuTemplate *CreateTemplate() override;
+	void ReleaseTemplate(IMenuTemplate *pTemplate) override;
+	IMenu *CreateInstanceFromTemplate(IMenuTemplate *pTemplate, IMenuProfile *pProfile, IMenuHandler *pHandler = nullptr, bool bSharePages = true) override;
+	IMenuTemplate *GetInstanceTemplate(IMenu *pMenu) override;
+	int DisplayInstanceToPlayers(IMenu *pMenu, const CPlayerBitVec &bvPlayers, IMenu::Handle_t *pHandles, IMenu::ItemPosition_t iStartItem = MENU_FIRST_ITEM_INDEX, int nManyTimes = MENU_TIME_FOREVER) override;
 
 	CMenu *CreateInternalMenu(IMenuProfile *pProfile, IMenuHandler *pHandler = nullptr);
 	bool UpdatePlayerMenus(CPlayerSlot aSlot);
 	bool DisplayInternalMenuToPlayer(CMenu *pInternalMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iStartItem = MENU_FIRST_ITEM_INDEX, int nManyTimes = MENU_TIME_FOREVER);
-	IMenuHandler *FindMenuHandler(IMenu *pMenu);
+	int DisplayInternalMenuToPlayers(CMenu *pInternalMenu, const CPlayerBitVec &bvPlayers, IMenu::Handle_t *pHandles, IMenu::ItemPosition_t iStartItem = MENU_FIRST_ITEM_INDEX, int nManyTimes = MENU_TIME_FOREVER); // Spawns the entities of all by one flush, an instance by a player. Returns a number of the displayed, and their handles by a slot.
+	CMenu *CreateInternalMenuCopy(CMenu *pInternalMenu); // A new instance of the same template, profile and handler.
+	bool PrepareInternalMenuDisplay(CMenu *pInternalMenu, CPlayerSlot aSlot); // Checks the player and spawns the menu entities.
+	bool FinishInternalMenuDisplay(CMenu *pInternalMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iStartItem, int nManyTimes); // Stacks the menu to the player and displays.
+	static IMenuHandler *GetMenuHandler(IMenu *pMenu) // Menus are always CMenu here, see CreateInternalMenu.
+	{
+		return static_cast<CMenu *>(pMenu)->GetNextHandler();
+	}
 	int DestroyInternalMenuEntities(CMenu *pInternalMenu);
-	bool CloseMenuHandler(IMenu *pMenu);
 	void CloseInternalMenu(CMenu *pInternalMenu, IMenuHandler::EndReason_t eReason, bool bCleanupPlayer = true);
+	bool QueueCloseMenu(IMenu *pMenu, IMenuHandler::EndReason_t eReason); // Detaches now, tears down at the next frame boundary.
+	void FlushCloseQueue();
+	void DetachMenuFromPlayers(CMenu *pInternalMenu); // Touches the menu viewers only.
+	void EnableRadarByMenu(CMenu *pInternalMenu); // For viewers whose last menu it is.
 	void PurgeAllMenus(); // Close all menus of the players.
+	int PrerenderAdjacentPages(double flBudget); // Of the active menus, within the budget in seconds. Returns a number of the rendered pages.
+
+public: // Render queue.
+	bool RenderOrQueueMenu(CMenu *pInternalMenu, CPlayerSlot aSlot, IMenu::DisplayFlags_t eFlags); // Renders an active menu now while the frame budget lasts, the rest are queued. Returns true if rendered.
+	void QueueMenuRender(CMenu *pInternalMenu, CPlayerSlot aSlot, IMenu::DisplayFlags_t eFlags); // The base renders go after the active ones.
+	void RemoveQueuedMenuRenders(const CMenu *pInternalMenu);
+	int DrainRenderQueue(double flBudget); // Within the budget in seconds, one at least. Returns a number of the rendered menus.
+	void DumpMenuStats(CBufferString &sOutput);
+
+public: // Menu entity pool.
+	bool TakePooledMenuEntities(const IMenuProfile *pProfile, CUtlVector<CEntityInstance *> &vecEntities);
+	int ReleaseMenuEntities(CMenu *pInternalMenu); // Pools the entities or pushes them to the destroy queue. Returns the pushed count.
+	void PurgeMenuEntityPool(bool bDestroy = true);
 
 public: // IMenuHandler
 	void OnMenuStart(IMenu *pMenu) override;
@@ -328,8 +360,9 @@ public: // IMenuHandler
 	void OnMenuSelect(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iItem) override;
 	void OnMenuEnd(IMenu *pMenu, EndReason_t eReason) override;
 	void OnMenuDestroy(IMenu *pMenu) override;
-	void OnMenuDrawTitle(IMenu *pMenu, CPlayerSlot aSlot, IMenu::Title_t &aTitle) override;
-	void OnMenuDisplayItem(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iItem, IMenu::Item_t &aData) override;
+	void OnMenuDisplayItemView(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iItem, IMenu::ItemView_t &aView) override;
+	void OnMenuDrawTitleView(IMenu *pMenu, CPlayerSlot aSlot, IMenu::TitleView_t &aView) override;
+	bool IsMenuRenderSlotSpecific(IMenu *pMenu, CPlayerSlot aSlot) override;
 
 	bool OnMenuExitButton(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iItem);
 	virtual bool OnMenuSwitch(CPlayerSlot aSlot);
@@ -406,6 +439,8 @@ public: // Entity Manager.
 	void SpawnEntities(const CUtlVector<CEntityKeyValues *> &vecKeyValues, CUtlVector<CEntityInstance *> *pEntities = nullptr, IEntityManager::IProviderAgent::IEntityListener *pListener = nullptr);
 	void SpawnMenu(CMenu *pMenu, CPlayerSlot aInitiatorSlot, const Vector &vecBackgroundOrigin, const Vector &vecOrigin, const QAngle &angRotation);
 	void SpawnMenuByEntityPosition(int iMenu, CMenu *pMenu, CPlayerSlot aInitiatorSlot, CBaseEntity *pTarget);
+	void BeginSpawnBatch(); // The next menu spawns push their keyvalues only.
+	int EndSpawnBatch(); // Spawns the pushed by one flush. Returns a number of the spawned sets.
 	CBaseViewModel *SpawnViewModelEntity(const Vector &vecOrigin, const QAngle &angRotation, CBaseEntity *pOwner, const int nSlot);
 
 	// Menu movement.
@@ -463,6 +498,9 @@ private:
 	CON_COMMAND_MEMBER_F(CThis, "mm_" META_PLUGIN_PREFIX "_reload_profiles", OnReloadProfilesCommand, "Reload menu profiles", FCVAR_LINKED_CONCOMMAND);
 	CON_COMMAND_MEMBER_F(CThis, "mm_" META_PLUGIN_PREFIX "_reload_translations", OnReloadTranslationsCommand, "Reload translations", FCVAR_LINKED_CONCOMMAND);
 
+	// Diagnostics.
+	CON_COMMAND_MEMBER_F(CThis, "mm_" META_PLUGIN_PREFIX "_stats", OnStatsCommand, "Print menu system statistics", FCVAR_LINKED_CONCOMMAND);
+
 	// Players interaction.
 	CON_COMMAND_MEMBER_F(CThis, "menuselect", OnMenuSelectCommand, "", FCVAR_LINKED_CONCOMMAND | FCVAR_CLIENT_CAN_EXECUTE);
 
@@ -470,6 +508,11 @@ private: // ConVars. See the constructor
 	CConVar<bool> m_aEnableClientCommandDetailsConVar;
 	CConVar<bool> m_aEnablePlayerRunCmdDetailsConVar;
 	CConVar<bool> m_aEnableSilentCommandDispatchConVar;
+	CConVar<int> m_aMenuWarmPoolSizeConVar;
+	CConVar<int> m_aMenuEntityPoolSizeConVar;
+	CConVar<int> m_aPageCacheBudgetConVar;
+	CConVar<int> m_aPrerenderBudgetConVar;
+	CConVar<int> m_aRenderBudgetConVar;
 
 public: // SourceHooks.
 	void OnStartupServerHook(const GameSessionConfiguration_t &config, ISource2WorldSession *pWorldSession, const char *);
@@ -558,7 +601,80 @@ private: // Fields.
 	CMenuData_t::ControlItems_t m_aControls;
 
 	CMenuAllocator<sizeof(CMenu)> m_MenuAllocator;
-	CUtlMap<const IMenu *, IMenuHandler *> m_mapMenuHandlers;
+
+	struct CloseQueued_t
+	{
+		CMenu *m_pInternalMenu;
+		IMenuHandler::EndReason_t m_eReason;
+	};
+
+	CUtlVector<CloseQueued_t> m_vecCloseQueue;
+
+	// Hidden, already spawned menu entities by profile and layer.
+	struct MenuEntityPool_t
+	{
+		CUtlVector<CEntityInstance *> m_vecLayers[MENU_MAX_ENTITIES];
+	};
+
+	struct MenuEntityPoolStats_t
+	{
+		int m_nReused = 0;
+		int m_nSpawned = 0;
+		int m_nReturned = 0;
+		int m_nDestroyed = 0;
+		int m_nBatchFlushes = 0;
+		int m_nBatchedSets = 0;
+	};
+
+	CUtlMap<const IMenuProfile *, MenuEntityPool_t *> m_mapMenuEntityPools;
+	int m_nPooledMenuEntities;
+	CBitVec<MAX_EDICTS> m_bvPooledMenuEntities; // By entity index, cleared from every transmit set at once.
+	MenuEntityPoolStats_t m_aMenuEntityPoolStats;
+
+private: // Spawn batch.
+	struct SpawnBatched_t
+	{
+		CMenu *m_pInternalMenu;
+		int m_iFirstKeyValues; // Of the batch, -1 if the entities are pooled.
+		int m_nEntities; // By the profile layers.
+		CEntityInstance *m_arrEntities[MENU_MAX_ENTITIES];
+	};
+
+	bool m_bSpawnBatching;
+	CUtlVector<CEntityKeyValues *> m_vecSpawnBatchKeyValues;
+	CUtlVector<SpawnBatched_t> m_vecSpawnBatch; // In the spawn order.
+
+private: // Prerender.
+	int m_iNextPrerenderClient; // Continues from the one out of the last budget.
+
+private: // Render queue.
+	enum RenderQueue_t : int
+	{
+		RENDER_QUEUE_ACTIVE = 0,
+		RENDER_QUEUE_BASE,
+
+		RENDER_QUEUE_MAX
+	};
+
+	struct RenderQueued_t
+	{
+		CMenu *m_pInternalMenu;
+		CPlayerSlot m_aSlot;
+		IMenu::DisplayFlags_t m_eFlags;
+	};
+
+	struct RenderQueueStats_t
+	{
+		int m_nPeakDepth = 0;
+		uint64 m_nRendered = 0;
+		uint64 m_nDeferredFrames = 0; // Left something for the next frame.
+		double m_flLastFrameTime = 0.0; // Of the renders in seconds.
+		double m_flPeakFrameTime = 0.0;
+	};
+
+	CUtlVector<RenderQueued_t> m_arrRenderQueues[RENDER_QUEUE_MAX];
+	double m_flFrameRenderTime; // Spent by this frame.
+	RenderQueueStats_t m_aRenderQueueStats;
 }; // MenuSystem_Plugin
 
 extern MenuSystem_Plugin *g_pMenuPlugin;
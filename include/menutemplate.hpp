@@ -0,0 +1,98 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Metamod:Source Menu System
+ * Written by Wend4r & komashchenko (Vladimir Ezhikov & Borys Komashchenko).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_METAMOD_SOURCE_MENUTEMPLATE_HPP_
+#	define _INCLUDE_METAMOD_SOURCE_MENUTEMPLATE_HPP_
+
+#	pragma once
+
+#	include <imenutemplate.hpp>
+#	include <menu.hpp>
+
+#	include <basetypes.h>
+
+class CMenuTemplate : public IMenuTemplate
+{
+public:
+	using CPageCache = CMenu::CPageCache;
+
+	CMenuTemplate(CMenuData_t::ControlItems_t *pControls = nullptr);
+
+public: // IMenuTemplate
+	const IMenu::Title_t &GetTitle() const override
+	{
+		return m_aData.m_title;
+	}
+
+	bool SetTitle(const char *pszNewText) override;
+
+	const IMenu::Items_t &GetItems() const override
+	{
+		return m_aData.m_vecItems;
+	}
+
+	IMenu::ItemPosition_t AddItem(const IMenu::Item_t &aItem) override;
+
+	IMenu::ItemControlFlags_t GetItemControls() const override
+	{
+		return m_aData.m_eControlFlags;
+	}
+
+	bool SetItemControls(IMenu::ItemControlFlags_t eNewControls) override;
+
+	bool IsSealed() const override
+	{
+		return m_bSealed;
+	}
+
+public:
+	CMenuData_t &GetDataRef()
+	{
+		return m_aData;
+	}
+
+	void Seal()
+	{
+		m_bSealed = true;
+	}
+
+	int AddRef()
+	{
+		return ++m_nRefCount;
+	}
+
+	int Release(); // Deletes the template with the last reference.
+
+	// Pages shared by the instances.
+	CPageCache &GetPageCache()
+	{
+		return m_aPageCache;
+	}
+
+private:
+	CMenuData_t m_aData;
+	bool m_bSealed;
+	int m_nRefCount;
+
+	CPageCache m_aPageCache;
+}; // CMenuTemplate
+
+#endif // _INCLUDE_METAMOD_SOURCE_MENUTEMPLATE_HPP_
@@ -28,6 +28,7 @@
 #	include "imenuinstance.hpp"
 #	include <basetypes.h>
 #	include <playerslot.h>
+#	include <tier0/strtools.h>
 #	if __has_include(<tier0/utlstring.h>)
 #		include <tier0/utlstring.h>
 #	else // Bcompatibility with HL2SDK
@@ -43,6 +44,7 @@
 #	define MENU_INVLID_INDEX static_cast<IMenu::Index_t>(-1)            ///< Invalid menu instance index.
 #	define MENU_FIRST_ITEM_INDEX static_cast<IMenu::ItemPosition_t>(0)  ///< The menu first item index.
 #	define MENU_NO_PAGINATION 0     ///< FUTURE: Menu should not be paginated (10 items max of "default" profile).
+#	define MENU_INVALID_HANDLE static_cast<IMenu::Handle_t>(0)          ///< Invalid menu instance handle.
 
 /**
  * @brief A Menu interface.
@@ -51,6 +53,7 @@ class IMenu : public IMenuInstance
 {
 public: // The definitions.
 	using Index_t = int;
+	using Handle_t = uint64; ///< An opaque instance handle: generation in the high 32 bits, slot in the low ones.
 	using ItemPosition_t = int;
 	using ItemPositionOnPage_t = int8;
 	using Pagination_t = uint8;
@@ -198,9 +201,155 @@ public: // The definitions.
 	};
 	using Items_t = CUtlVector<Item_t>;
 
+	/**
+	 * @brief A copy-on-write view of an item to display.
+	 * Reads the original item until a handler changes it, 
+	 * so an untouched item is never copied.
+	 */
+	class ItemView_t
+	{
+	public:
+		ItemView_t(const Item_t &aOriginal)
+		 :  m_pOriginal(&aOriginal), 
+		    m_eStyle(aOriginal.m_eStyle), 
+		    m_pszContent(aOriginal.Get())
+		{
+		}
+
+		const Item_t &GetOriginal() const
+		{
+			return *m_pOriginal;
+		}
+
+		bool IsEmpty() const
+		{
+			return !m_pszContent || !m_pszContent[0];
+		}
+
+		ItemStyleFlags_t GetStyle() const
+		{
+			return m_eStyle;
+		}
+
+		void SetStyle(ItemStyleFlags_t eNewStyle)
+		{
+			m_eStyle = eNewStyle;
+		}
+
+		const char *Get() const
+		{
+			return m_pszContent;
+		}
+
+		// Copies the content.
+		void Set(const char *pszNewValue)
+		{
+			m_sContent.Set(pszNewValue);
+			m_pszContent = m_sContent.Get();
+		}
+
+		// References the content, which must outlive the render.
+		void SetRef(const char *pszNewValue)
+		{
+			m_pszContent = pszNewValue;
+		}
+
+	private:
+		const Item_t *m_pOriginal;
+		ItemStyleFlags_t m_eStyle;
+		const char *m_pszContent;
+		CUtlString m_sContent; // Allocated by Set() only.
+	};
+
+	/**
+	 * @brief A copy-on-write view of a title to draw.
+	 * Reads the original title until a handler changes it, 
+	 * so an untouched title is never copied.
+	 */
+	class TitleView_t
+	{
+	public:
+		TitleView_t(const Title_t &aOriginal)
+		 :  m_pOriginal(&aOriginal), 
+		    m_pszText(aOriginal.Get()), 
+		    m_nLength(aOriginal.m_sText.Length())
+		{
+		}
+
+		const Title_t &GetOriginal() const
+		{
+			return *m_pOriginal;
+		}
+
+		bool IsEmpty() const
+		{
+			return !m_nLength;
+		}
+
+		const char *Get() const
+		{
+			return m_pszText;
+		}
+
+		int Length() const
+		{
+			return m_nLength;
+		}
+
+		// Copies the text.
+		void Set(const char *pszNewValue)
+		{
+			m_sText.Set(pszNewValue);
+			m_pszText = m_sText.Get();
+			m_nLength = m_sText.Length();
+		}
+
+		// References the text, which must outlive the render.
+		void SetRef(const char *pszNewValue)
+		{
+			m_pszText = pszNewValue;
+			m_nLength = pszNewValue ? V_strlen(pszNewValue) : 0;
+		}
+
+	private:
+		const Title_t *m_pOriginal;
+		const char *m_pszText;
+		int m_nLength;
+		CUtlString m_sText; // Allocated by Set() only.
+	};
+
+	/**
+	 * @brief A source of the items, asked for the displayed page only.
+	 * Instead of holding all of them, a menu gets the items of a page
+	 * on its render or selection, so the memory follows the page size.
+	 */
+	class IItemSource
+	{
+	public:
+		/**
+		 * @brief Gets a count of the items.
+		 *
+		 * @param pMenu         Pointer to the menu instance.
+		 *
+		 * @return              The count of the items.
+		 */
+		virtual ItemPosition_t GetItemCount(IMenu *pMenu) = 0;
+
+		/**
+		 * @brief Gets the items of a range.
+		 *
+		 * @param pMenu         Pointer to the menu instance.
+		 * @param iStartItem    The first item position.
+		 * @param nCount        A count of the items.
+		 * @param vecItems      The items to append to, one per position.
+		 */
+		virtual void GetItems(IMenu *pMenu, ItemPosition_t iStartItem, ItemPosition_t nCount, Items_t &vecItems) = 0;
+	};
+
 public: // Public methods.
 	/**
 	 * @brief Gets a reference to the menu title.
+	 * NOTE: An instance of a template copies the template data to own it.
 	 * 
 	 * @return Reference to the menu title.
 	 */
@@ -208,6 +357,7 @@ public: // Public methods.
 
 	/**
 	 * @brief Gets a reference to the collection of menu items.
+	 * NOTE: An instance of a template copies the template data to own it.
 	 * 
 	 * @return Reference to the collection of menu items.
 	 */
@@ -255,6 +405,125 @@ public: // Public methods.
 	 *                      `false` otherwise.
 	 */
 	virtual bool InternalDisplayAt(CPlayerSlot aSlot, ItemPosition_t iStartItem = MENU_FIRST_ITEM_INDEX, DisplayFlags_t eFlags = MENU_DISPLAY_DEFAULT) = 0;
+
+	/**
+	 * @brief Gets the menu title to read.
+	 * NOTE: Unlike GetTitleRef(), keeps the data of a template instance shared.
+	 * 
+	 * @return Reference to the menu title.
+	 */
+	virtual const Title_t &GetTitle() const = 0;
+
+	/**
+	 * @brief Gets the collection of menu items to read.
+	 * NOTE: Unlike GetItemsRef(), keeps the data of a template instance shared.
+	 * 
+	 * @return Reference to the collection of menu items.
+	 */
+	virtual const Items_t &GetItems() const = 0;
+
+	/**
+	 * @brief Gets the menu controls to read.
+	 * 
+	 * @return The menu control flags.
+	 */
+	virtual ItemControlFlags_t GetItemControls() const = 0;
+
+	/**
+	 * @brief Adds an item to the end.
+	 * NOTE: Unlike GetItemsRef(), marks only the last pages changed, 
+	 *       which are re-rendered for the players on them.
+	 * 
+	 * @param aItem         The item to add.
+	 * 
+	 * @return              The position of the added item.
+	 */
+	virtual ItemPosition_t AddItem(const Item_t &aItem) = 0;
+
+	/**
+	 * @brief Removes an item, marking the pages from it changed.
+	 * 
+	 * @param iItem         The item position.
+	 * 
+	 * @return              `true` if the item was removed, 
+	 *                      `false` if the position is out of range.
+	 */
+	virtual bool RemoveItem(ItemPosition_t iItem) = 0;
+
+	/**
+	 * @brief Sets the content of an item, marking the page with it changed.
+	 * 
+	 * @param iItem         The item position.
+	 * @param pszContent    A new content.
+	 * 
+	 * @return              `true` if the item was changed, 
+	 *                      `false` if the position is out of range.
+	 */
+	virtual bool SetItemContent(ItemPosition_t iItem, const char *pszContent) = 0;
+
+	/**
+	 * @brief Sets the style of an item, marking the page with it changed.
+	 * 
+	 * @param iItem         The item position.
+	 * @param eStyle        New style flags.
+	 * 
+	 * @return              `true` if the item was changed, 
+	 *                      `false` if the position is out of range.
+	 */
+	virtual bool SetItemStyle(ItemPosition_t iItem, ItemStyleFlags_t eStyle) = 0;
+
+	/**
+	 * @brief Gets a count of the pages.
+	 * NOTE: Items with empty content are hidden, so take no place on pages.
+	 * 
+	 * @return              The count of the pages, at least one.
+	 */
+	virtual int GetPageCount() = 0;
+
+	/**
+	 * @brief Gets the start item of a page, to display it.
+	 * 
+	 * @param iPage         The page number, from zero.
+	 * 
+	 * @return              The start item position, 
+	 *                      or -1 if the page is out of range.
+	 */
+	virtual ItemPosition_t GetPageStartItem(int iPage) = 0;
+
+	/**
+	 * @brief Gets the page number of an item.
+	 * 
+	 * @param iItem         The item position.
+	 * 
+	 * @return              The page number, clamped to the first and the last pages.
+	 */
+	virtual int GetPageOfItem(ItemPosition_t iItem) = 0;
+
+	/**
+	 * @brief Sets a source of the items, which are paged by its count.
+	 * NOTE: Own items are not displayed while a source is set.
+	 *
+	 * @param pSource       The item source, must outlive the menu,
+	 *                      or nullptr to display own items again.
+	 */
+	virtual void SetItemSource(IItemSource *pSource) = 0;
+
+	/**
+	 * @brief Gets the item source.
+	 *
+	 * @return              The item source, or nullptr if not set.
+	 */
+	virtual IItemSource *GetItemSource() const = 0;
+
+	/**
+	 * @brief Marks the items of a range changed,
+	 *        which re-renders their pages for the players on them.
+	 * NOTE: Intended to update the items of a source.
+	 *
+	 * @param iFirst        The first item position.
+	 * @param iLast         The last item position.
+	 */
+	virtual void MarkItemsChanged(ItemPosition_t iFirst, ItemPosition_t iLast) = 0;
 }; // IMenuInstance
 
 #endif // _INCLUDE_METAMOD_SOURCE_IMENU_HPP_
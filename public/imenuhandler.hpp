@@ -29,6 +29,7 @@
 
 #include <basetypes.h>
 #include <playerslot.h>
+#include <tier0/strtools.h>
 
 /**
  * @file imenu.hpp
@@ -58,6 +59,17 @@ public: // The definitions.
 		MenuEnd_ExitBack = 7,           ///< Client selected "exit back" on a paginated menu.
 	};
 
+	/**
+	 * @brief Flags of the copying callbacks a handler overrides, see GetMenuOverrides().
+	 */
+	enum OverrideFlags_t : uint8
+	{
+		MENU_HANDLER_OVERRIDES_NONE = 0,
+		MENU_HANDLER_OVERRIDES_DRAW_TITLE = (1 << 0),    ///< OnMenuDrawTitle() is overridden.
+		MENU_HANDLER_OVERRIDES_DISPLAY_ITEM = (1 << 1),  ///< OnMenuDisplayItem() is overridden.
+		MENU_HANDLER_OVERRIDES_ALL = (MENU_HANDLER_OVERRIDES_DRAW_TITLE | MENU_HANDLER_OVERRIDES_DISPLAY_ITEM),
+	};
+
 public: // Public methods.
 	/** 
 	 * @brief Invoked when a menu display/selection cycle begins.
@@ -116,6 +128,90 @@ public: // Public methods.
 	 * @param aData         The reference to an item data to modify.
 	 */
 	virtual void OnMenuDisplayItem(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iItem, IMenu::Item_t &aData) {}
+
+	/**
+	 * @brief Invoked before a page is rendered for a player, to know if the page can be shared.
+	 * Rendered pages are shared by the players who see the same content in the same language.
+	 *
+	 * @param pMenu         A pointer to the menu instance.
+	 * @param aSlot         The client slot.
+	 *
+	 * @return              `true` if the title or items are customized for the player, 
+	 *                      so the page is rendered for the player only,
+	 *                      `false` otherwise.
+	 */
+	virtual bool IsMenuRenderSlotSpecific(IMenu *pMenu, CPlayerSlot aSlot) { return false; }
+
+	/**
+	 * @brief Invoked to customize the rendering of a specific menu item without copying it.
+	 * By default, copies the item for OnMenuDisplayItem() if GetMenuOverrides() has 
+	 * MENU_HANDLER_OVERRIDES_DISPLAY_ITEM, which existing handlers have, 
+	 * so they keep the cost of a copy by an item.
+	 *
+	 * @param pMenu         A pointer to the menu instance.
+	 * @param aSlot         The client slot.
+	 * @param iItem         The item index. Can be `ItemControls_t` values.
+	 * @param aView         The reference to a copy-on-write item view to modify.
+	 */
+	virtual void OnMenuDisplayItemView(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iItem, IMenu::ItemView_t &aView)
+	{
+		if(!(GetMenuOverrides() & MENU_HANDLER_OVERRIDES_DISPLAY_ITEM))
+		{
+			return;
+		}
+
+		const auto &aOriginal = aView.GetOriginal();
+
+		IMenu::Item_t aItemCopy(aView.GetStyle(), aView.Get(), aOriginal.m_pHandler, aOriginal.m_pData);
+
+		OnMenuDisplayItem(pMenu, aSlot, iItem, aItemCopy);
+
+		aView.SetStyle(aItemCopy.GetStyle());
+
+		if(V_strcmp(aItemCopy.Get(), aView.Get()))
+		{
+			aView.Set(aItemCopy.Get());
+		}
+	}
+
+	/**
+	 * @brief Invoked to determine how a menu title should be rendered, without copying it.
+	 * By default, copies the title for OnMenuDrawTitle() if GetMenuOverrides() has 
+	 * MENU_HANDLER_OVERRIDES_DRAW_TITLE, which existing handlers have, 
+	 * so they keep the cost of a copy by a render.
+	 *
+	 * @param pMenu         A pointer to the menu instance.
+	 * @param aSlot         The client slot.
+	 * @param aView         The reference to a copy-on-write title view to modify.
+	 */
+	virtual void OnMenuDrawTitleView(IMenu *pMenu, CPlayerSlot aSlot, IMenu::TitleView_t &aView)
+	{
+		if(!(GetMenuOverrides() & MENU_HANDLER_OVERRIDES_DRAW_TITLE))
+		{
+			return;
+		}
+
+		IMenu::Title_t aTitleCopy;
+
+		aTitleCopy.Set(aView.Get());
+
+		OnMenuDrawTitle(pMenu, aSlot, aTitleCopy);
+
+		if(V_strcmp(aTitleCopy.Get(), aView.Get()))
+		{
+			aView.Set(aTitleCopy.Get());
+		}
+	}
+
+	/**
+	 * @brief Gets the copying callbacks the handler overrides, 
+	 * so the default views copy the title and items for them only.
+	 * NOTE: Returns MENU_HANDLER_OVERRIDES_ALL by default, as a handler 
+	 *       may not know of it. Override to return only the overridden ones.
+	 *
+	 * @return              The override flags.
+	 */
+	virtual OverrideFlags_t GetMenuOverrides() const { return MENU_HANDLER_OVERRIDES_ALL; }
 };
 
 #endif // _INCLUDE_METAMOD_SOURCE_IMENUHANDLER_HPP_
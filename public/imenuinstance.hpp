@@ -76,6 +76,7 @@ public:
 
 	/**
 	 * @brief Applies a profile with the menu customization.
+	 * NOTE: A profile of another layer count is not applied to the spawned entities.
 	 *
 	 * @param aSlot         The player slot who applies a profile to prereder.
 	 *                      `INVALID_PLAYER_SLOT` if the server.
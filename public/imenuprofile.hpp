@@ -41,6 +41,10 @@ class CEntityKeyValues;
 #define MENU_MAX_FONT_NAME_LENGTH 64
 #define MENU_MAX_FONT_BACKGROUND_MATERIAL_NAME_LENGTH 64
 
+#define MENU_PROFILE_MIN_LAYERS 2       ///< The background and the active layers, inactive items are drawn by the background.
+#define MENU_PROFILE_MERGED_LAYERS 3    ///< The disabled active layer is merged to the inactive one.
+#define MENU_PROFILE_MAX_LAYERS 4       ///< An entity by each layer, see MenuEntity_t.
+
 /**
  * @brief A Menu Profile interface.
 **/
@@ -153,6 +157,13 @@ public: // Abstract methods.
 	 *                              Must be deleted!
 	 */
 	virtual CEntityKeyValues *GetAllocactedEntityKeyValues(CKeyValues3Context *pAllocator = nullptr, bool bIncludeBackground = true) const = 0;
+
+	/**
+	 * @brief Gets a count of the text layers, each is a networked entity of a menu.
+	 * 
+	 * @return Returns a count from MENU_PROFILE_MIN_LAYERS to MENU_PROFILE_MAX_LAYERS.
+	 */
+	virtual int GetLayers() const = 0;
 }; // IMenuProfile
 
 #endif // _INCLUDE_METAMOD_SOURCE_IMENUPROFILE_HPP_
@@ -27,10 +27,11 @@
 
 #	include "imenusystem/isample.hpp"
 #	include "imenu.hpp"
+#	include "imenutemplate.hpp"
 
 #	include <tier1/utlvector.h>
 
-#	define MENUSYSTEM_INTERFACE_NAME "Menu System v1.0.0"
+#	define MENUSYSTEM_INTERFACE_NAME "Menu System v1.1.0"
 #	define MENU_TIME_FOREVER 0      ///< The menu/panel should be displayed as long as possible.
 
 class CEntityInstance; // See <entity2/entitysystem.h> of Source SDK.
@@ -38,6 +39,7 @@ class IMenu; // See "imenu.hpp".
 class IMenuProfile; // See "imenuprofile.hpp".
 class IMenuProfileSystem; // See "imenuprofilesystem.hpp".
 class IMenuHandler; // See "imenuhandler.hpp".
+class IMenuTemplate; // See "imenutemplate.hpp".
 
 /**
  * @brief A Menu System interface.
@@ -118,12 +120,113 @@ public:
 
 	/**
 	 * @brief Closes a menu instance.
+	 * The instance is detached from players at once, 
+	 * and its teardown is batched at the next frame boundary.
 	 * 
 	 * @param pMenu         A menu instance to close.
 	 * 
-	 * @return              
+	 * @return              `true` if the instance was queued to close,
+	 *                      `false` otherwise.
 	 */
 	virtual bool CloseInstance(IMenu *pMenu) = 0;
+
+	/**
+	 * @brief Closes a menu instance immediately, without batching.
+	 * 
+	 * @param pMenu         A menu instance to close.
+	 * 
+	 * @return              `true` if the instance was closed,
+	 *                      `false` otherwise.
+	 */
+	virtual bool CloseInstanceNow(IMenu *pMenu) = 0;
+
+	/**
+	 * @brief Gets a handle of a menu instance.
+	 * A handle stays cacheable and becomes stale once the instance is closed.
+	 * 
+	 * @param pMenu         The menu instance.
+	 * 
+	 * @return              Returns the instance handle, 
+	 *                      or MENU_INVALID_HANDLE if the instance is not alive.
+	 */
+	virtual IMenu::Handle_t GetInstanceHandle(IMenu *pMenu) = 0;
+
+	/**
+	 * @brief Finds a menu instance by its handle.
+	 * 
+	 * @param hMenu         The instance handle.
+	 * 
+	 * @return              Returns the menu instance, 
+	 *                      or nullptr if the handle is stale or invalid.
+	 */
+	virtual IMenu *FindInstanceByHandle(IMenu::Handle_t hMenu) = 0;
+
+	/**
+	 * @brief Allocates an empty menu template to fill.
+	 * NOTE: Must be released with ReleaseTemplate()!
+	 * 
+	 * @return              Returns the allocated template.
+	 */
+	virtual IMenuTemplate *CreateTemplate() = 0;
+
+	/**
+	 * @brief Releases a menu template.
+	 * The template is kept until the last instance of it is closed.
+	 * 
+	 * @param pTemplate     A template to release.
+	 */
+	virtual void ReleaseTemplate(IMenuTemplate *pTemplate) = 0;
+
+	/**
+	 * @brief Allocates a menu instance referencing the template data.
+	 * The template becomes sealed. Writes through the IMenu references 
+	 * copy the template data to the instance.
+	 * NOTE: Must be closed with CloseInstance()!
+	 * 
+	 * @param pTemplate     The template of the menu.
+	 * @param pProfile      The profile styles of new menu.
+	 * @param pHandler      A menu handler.
+	 * @param bSharePages   Whether rendered pages are shared with other instances of the template.
+	 *                      Pass `false` if the handler customizes the title or items 
+	 *                      by OnMenuDrawTitle() or OnMenuDisplayItem() per player.
+	 * 
+	 * @return              Returns the allocated menu instance.
+	 */
+	virtual IMenu *CreateInstanceFromTemplate(IMenuTemplate *pTemplate, IMenuProfile *pProfile, IMenuHandler *pHandler = nullptr, bool bSharePages = true) = 0;
+
+	/**
+	 * @brief Gets a template of a menu instance.
+	 * 
+	 * @param pMenu         The menu instance.
+	 * 
+	 * @return              Returns the template, 
+	 *                      or nullptr if the instance was not created from one.
+	 */
+	virtual IMenuTemplate *GetInstanceTemplate(IMenu *pMenu) = 0;
+
+	/**
+	 * @brief Display a menu instance to the players at once.
+	 * Spawns the menu entities of all the players by one spawn queue flush, 
+	 * instead of one by a player.
+	 * An instance holds the entities of one player, so the first player gets 
+	 * the instance itself and the others get new instances of its template 
+	 * (see CreateInstanceFromTemplate), with the same profile, handler and item source.
+	 * NOTE: Each displayed instance must be closed with CloseInstance(), 
+	 *       closing the passed one does not close the others.
+	 * NOTE: A menu without a template, or with the template data changed, 
+	 *       is rejected for more than one player.
+	 * 
+	 * @param pMenu         The menu instance.
+	 * @param bvPlayers     The player slots.
+	 * @param pHandles      An array of ABSOLUTE_PLAYER_LIMIT by a player slot to get 
+	 *                      the handles of the displayed instances, 
+	 *                      MENU_INVALID_HANDLE for the players it was not displayed to.
+	 * @param iStartItem    The starting item position (default: MENU_FIRST_ITEM_INDEX).
+	 * @param nManyTimes    The display time in seconds (default: MENU_TIME_FOREVER).
+	 * 
+	 * @return              A number of the players the menu was displayed to.
+	 */
+	virtual int DisplayInstanceToPlayers(IMenu *pMenu, const CPlayerBitVec &bvPlayers, IMenu::Handle_t *pHandles, IMenu::ItemPosition_t iStartItem = MENU_FIRST_ITEM_INDEX, int nManyTimes = MENU_TIME_FOREVER) = 0;
 }; // IMenuSystem
 
 #endif // _INCLUDE_METAMOD_SOURCE_IMENUSYSTEM_HPP_
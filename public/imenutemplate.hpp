@@ -0,0 +1,103 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Metamod:Source Menu System
+ * Written by Wend4r & komashchenko (Vladimir Ezhikov & Borys Komashchenko).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_METAMOD_SOURCE_IMENUTEMPLATE_HPP_
+#	define _INCLUDE_METAMOD_SOURCE_IMENUTEMPLATE_HPP_
+
+#	pragma once
+
+#	include "imenu.hpp"
+
+/**
+ * @file imenutemplate.hpp
+ * @brief Defines an IMenuTemplate interface for menu data shared by many instances.
+ */
+
+/**
+ * @brief A Menu Template interface.
+ * Holds a title, items and controls once for every instance created from it.
+ * The template is filled first and becomes sealed (read-only) 
+ * when the first instance is created from it.
+**/
+class IMenuTemplate
+{
+public:
+	/**
+	 * @brief Gets a title of the template.
+	 * 
+	 * @return              Returns the title.
+	 */
+	virtual const IMenu::Title_t &GetTitle() const = 0;
+
+	/**
+	 * @brief Sets a title of the template.
+	 * 
+	 * @param pszNewText    The title text.
+	 * 
+	 * @return              `true` if the title was set,
+	 *                      `false` if the template is sealed.
+	 */
+	virtual bool SetTitle(const char *pszNewText) = 0;
+
+	/**
+	 * @brief Gets the items of the template.
+	 * 
+	 * @return              Returns the items.
+	 */
+	virtual const IMenu::Items_t &GetItems() const = 0;
+
+	/**
+	 * @brief Adds an item to the template.
+	 * 
+	 * @param aItem         The item to add.
+	 * 
+	 * @return              Returns a position of the added item, 
+	 *                      or -1 if the template is sealed.
+	 */
+	virtual IMenu::ItemPosition_t AddItem(const IMenu::Item_t &aItem) = 0;
+
+	/**
+	 * @brief Gets the item controls of the template.
+	 * 
+	 * @return              Returns the control flags.
+	 */
+	virtual IMenu::ItemControlFlags_t GetItemControls() const = 0;
+
+	/**
+	 * @brief Sets the item controls of the template.
+	 * 
+	 * @param eNewControls  The control flags.
+	 * 
+	 * @return              `true` if the controls were set,
+	 *                      `false` if the template is sealed.
+	 */
+	virtual bool SetItemControls(IMenu::ItemControlFlags_t eNewControls) = 0;
+
+	/**
+	 * @brief Checks if the template is sealed by an instance.
+	 * 
+	 * @return              `true` if the template is read-only,
+	 *                      `false` otherwise.
+	 */
+	virtual bool IsSealed() const = 0;
+}; // IMenuTemplate
+
+#endif // _INCLUDE_METAMOD_SOURCE_IMENUTEMPLATE_HPP_
@@ -49,15 +49,21 @@
 using IMenuSystem_t = IMenuSystem;
 using IMenuProfileSystem_t = IMenuProfileSystem;
 using IMenu_t = IMenu;
+using IMenuTemplate_t = IMenuTemplate;
+using IMenuHandle_t = IMenu::Handle_t;
 using IMenuItemPosition_t = IMenu::ItemPosition_t;
 using IMenuItemStyleFlags_t = IMenu::ItemStyleFlags_t;
-using IMenuItemHandler_t = void (*)(IMenu_t *pMenu, CPlayerSlot aSlot, IMenuItemPosition_t iItem, IMenuItemPosition_t iItemOnPage, void *pData);
+using IMenuItemHandler_t = void (*)(IMenuHandle_t hMenu, CPlayerSlot aSlot, IMenuItemPosition_t iItem, IMenuItemPosition_t iItemOnPage, void *pData);
 using IMenuItemControlFlags_t = IMenu::ItemControlFlags_t;
+using IMenuItemSourceCount_t = IMenuItemPosition_t (*)(IMenuHandle_t hMenu, void *pData);
+using IMenuItemSourceContent_t = const char *(*)(IMenuHandle_t hMenu, IMenuItemPosition_t iItem, IMenuItemStyleFlags_t *pStyles, void *pData);
 using IMenuProfile_t = IMenuProfile;
 #	else
 typedef void IMenuSystem_t;
 typedef void IMenuProfileSystem_t;
 typedef void IMenu_t;
+typedef void IMenuTemplate_t;
+typedef unsigned long long IMenuHandle_t;
 typedef int CPlayerSlot;
 typedef int IMenuItemPosition_t;
 enum IMenuItemStyleFlags_t
@@ -66,7 +72,7 @@ enum IMenuItemStyleFlags_t
 	MENU_ITEM_HASNUMBER =   (1 << 1),
 	MENU_ITEM_CONTROL =     (1 << 2),
 };
-typedef void (*IMenuItemHandler_t)(IMenu_t *pMenu, CPlayerSlot aSlot, IMenuItemPosition_t iItem, IMenuItemPosition_t iItemOnPage, void *pData);
+typedef void (*IMenuItemHandler_t)(IMenuHandle_t hMenu, CPlayerSlot aSlot, IMenuItemPosition_t iItem, IMenuItemPosition_t iItemOnPage, void *pData);
 enum IMenuItemControlFlags_t
 {
 	MENU_ITEM_CONTROL_FLAG_PANEL = 0,
@@ -74,40 +80,74 @@ enum IMenuItemControlFlags_t
 	MENU_ITEM_CONTROL_FLAG_NEXT = (1 << 1),
 	MENU_ITEM_CONTROL_FLAG_EXIT = (1 << 2),
 };
+typedef IMenuItemPosition_t (*IMenuItemSourceCount_t)(IMenuHandle_t hMenu, void *pData);
+typedef const char *(*IMenuItemSourceContent_t)(IMenuHandle_t hMenu, IMenuItemPosition_t iItem, IMenuItemStyleFlags_t *pStyles, void *pData);
 typedef void IMenuProfile_t;
 #	endif // __cplusplus
 
+// Menu instances are passed as opaque handles (slot index and generation). 
+// A closed instance invalidates its handle, so the calls below reject it and return a default value.
+#	define MENU_EXPORT_INVALID_HANDLE 0ULL
+#	define MENU_EXPORT_INVALID_ITEM_STYLES ((IMenuItemStyleFlags_t)0xFF) // All the bits, of an invalid handle or an item out of range.
+
 /// The menu system.
 MENU_DLL_EXPORT IMenuSystem_t *MenuSystem(); // Gets a main pointer to menu system.
 MENU_DLL_EXPORT IMenuProfileSystem_t *MenuSystem_GetProfiles(IMenuSystem_t *pSystem); // See IMenuSystem::GetProfiles.
-MENU_DLL_EXPORT IMenu_t *MenuSystem_CreateInstance(IMenuSystem_t *pSystem, IMenuProfile_t *pProfile); // See IMenuSystem::CreateInstance.
-MENU_DLL_EXPORT bool MenuSystem_DisplayInstanceToPlayer(IMenuSystem_t *pSystem, IMenu_t *pMenuInstance, CPlayerSlot aSlot, IMenuItemPosition_t iStartItem = 0, int nManyTimes = 0); // See IMenuSystem::DisplayInstanceToPlayer.
-MENU_DLL_EXPORT bool MenuSystem_CloseInstance(IMenuSystem_t *pSystem, IMenu_t *pMenuInstance); // See IMenuSystem::CloseInstance.
+MENU_DLL_EXPORT IMenuHandle_t MenuSystem_CreateInstance(IMenuSystem_t *pSystem, IMenuProfile_t *pProfile); // See IMenuSystem::CreateInstance.
+MENU_DLL_EXPORT bool MenuSystem_DisplayInstanceToPlayer(IMenuSystem_t *pSystem, IMenuHandle_t hMenu, CPlayerSlot aSlot, IMenuItemPosition_t iStartItem = 0, int nManyTimes = 0); // See IMenuSystem::DisplayInstanceToPlayer.
+MENU_DLL_EXPORT int MenuSystem_DisplayInstanceToPlayers(IMenuSystem_t *pSystem, IMenuHandle_t hMenu, unsigned long long nPlayerMask, IMenuHandle_t *pHandles, IMenuItemPosition_t iStartItem = 0, int nManyTimes = 0); // See IMenuSystem::DisplayInstanceToPlayers. A bit of the mask by a player slot, the handles are by a slot too.
+MENU_DLL_EXPORT bool MenuSystem_CloseInstance(IMenuSystem_t *pSystem, IMenuHandle_t hMenu); // See IMenuSystem::CloseInstance.
+MENU_DLL_EXPORT bool MenuSystem_CloseInstanceNow(IMenuSystem_t *pSystem, IMenuHandle_t hMenu); // See IMenuSystem::CloseInstanceNow.
+MENU_DLL_EXPORT bool MenuSystem_IsValidInstance(IMenuSystem_t *pSystem, IMenuHandle_t hMenu); // See IMenuSystem::FindInstanceByHandle.
+MENU_DLL_EXPORT IMenuTemplate_t *MenuSystem_CreateTemplate(IMenuSystem_t *pSystem); // See IMenuSystem::CreateTemplate.
+MENU_DLL_EXPORT void MenuSystem_ReleaseTemplate(IMenuSystem_t *pSystem, IMenuTemplate_t *pTemplate); // See IMenuSystem::ReleaseTemplate.
+MENU_DLL_EXPORT IMenuHandle_t MenuSystem_CreateInstanceFromTemplate(IMenuSystem_t *pSystem, IMenuTemplate_t *pTemplate, IMenuProfile_t *pProfile); // See IMenuSystem::CreateInstanceFromTemplate.
 
 /// The menu profile system.
 MENU_DLL_EXPORT IMenuProfile_t *MenuProfileSystem_Get(IMenuProfileSystem_t *pProfileSystem, const char *pszName = "default");
 
+/// The menu template. Filled before the first instance is created from it.
+
+// See IMenuTemplate.
+MENU_DLL_EXPORT bool MenuTemplate_SetTitle(IMenuTemplate_t *pTemplate, const char *pszNewText);
+MENU_DLL_EXPORT IMenuItemPosition_t MenuTemplate_AddItem(IMenuTemplate_t *pTemplate, IMenuItemStyleFlags_t eFlags, const char *pszContent, IMenuItemHandler_t pfnItemHandler = NULL, void *pData = NULL);
+MENU_DLL_EXPORT bool MenuTemplate_SetItemControls(IMenuTemplate_t *pTemplate, IMenuItemControlFlags_t eNewControls);
+
 /// The menu instance.
 
 // See IMenu::GetTitleRef
-MENU_DLL_EXPORT const char *Menu_GetTitle(IMenu_t *pMenu);
-MENU_DLL_EXPORT void Menu_SetTitle(IMenu_t *pMenu, const char *pszNewText);
+MENU_DLL_EXPORT const char *Menu_GetTitle(IMenuHandle_t hMenu);
+MENU_DLL_EXPORT void Menu_SetTitle(IMenuHandle_t hMenu, const char *pszNewText);
 
-// See IMenu::GetItemsRef.
-MENU_DLL_EXPORT IMenuItemStyleFlags_t Menu_GetItemStyles(IMenu_t *pMenu, IMenuItemPosition_t iItem);
-MENU_DLL_EXPORT const char *Menu_GetItemContent(IMenu_t *pMenu, IMenuItemPosition_t iItem);
-MENU_DLL_EXPORT IMenuItemPosition_t Menu_AddItem(IMenu_t *pMenu, IMenuItemStyleFlags_t eFlags, const char *pszContent, IMenuItemHandler_t pfnItemHandler = NULL, void *pData = NULL);
-MENU_DLL_EXPORT void Menu_RemoveItem(IMenu_t *pMenu, IMenuItemPosition_t iItem);
+// See IMenu::GetItems. An item out of range returns MENU_EXPORT_INVALID_ITEM_STYLES and NULL content.
+MENU_DLL_EXPORT IMenuItemStyleFlags_t Menu_GetItemStyles(IMenuHandle_t hMenu, IMenuItemPosition_t iItem);
+MENU_DLL_EXPORT const char *Menu_GetItemContent(IMenuHandle_t hMenu, IMenuItemPosition_t iItem);
+
+// See IMenu::AddItem, IMenu::RemoveItem, IMenu::SetItemStyle and IMenu::SetItemContent. Re-render only the changed pages.
+MENU_DLL_EXPORT IMenuItemPosition_t Menu_AddItem(IMenuHandle_t hMenu, IMenuItemStyleFlags_t eFlags, const char *pszContent, IMenuItemHandler_t pfnItemHandler = NULL, void *pData = NULL);
+MENU_DLL_EXPORT void Menu_RemoveItem(IMenuHandle_t hMenu, IMenuItemPosition_t iItem);
+MENU_DLL_EXPORT bool Menu_SetItemStyles(IMenuHandle_t hMenu, IMenuItemPosition_t iItem, IMenuItemStyleFlags_t eNewStyles);
+MENU_DLL_EXPORT bool Menu_SetItemContent(IMenuHandle_t hMenu, IMenuItemPosition_t iItem, const char *pszNewContent);
 
 // See IMenu::GetItemControlsRef.
-MENU_DLL_EXPORT IMenuItemControlFlags_t Menu_GetItemControls(IMenu_t *pMenu);
-MENU_DLL_EXPORT void Menu_SetItemControls(IMenu_t *pMenu, IMenuItemControlFlags_t eNewControls);
+MENU_DLL_EXPORT IMenuItemControlFlags_t Menu_GetItemControls(IMenuHandle_t hMenu);
+MENU_DLL_EXPORT void Menu_SetItemControls(IMenuHandle_t hMenu, IMenuItemControlFlags_t eNewControls);
+
+// See IMenu::GetPageCount, IMenu::GetPageStartItem and IMenu::GetPageOfItem. Display the start item to jump to a page.
+MENU_DLL_EXPORT int Menu_GetPageCount(IMenuHandle_t hMenu);
+MENU_DLL_EXPORT IMenuItemPosition_t Menu_GetPageStartItem(IMenuHandle_t hMenu, int iPage);
+MENU_DLL_EXPORT int Menu_GetPageOfItem(IMenuHandle_t hMenu, IMenuItemPosition_t iItem);
+
+// See IMenu::SetItemSource and IMenu::MarkItemsChanged. The callbacks are asked for the items of the displayed page only, 
+// the content is copied and its styles are preset to the default ones. Pass NULL callbacks to display own items again.
+MENU_DLL_EXPORT bool Menu_SetItemSource(IMenuHandle_t hMenu, IMenuItemSourceCount_t pfnCount, IMenuItemSourceContent_t pfnContent, IMenuItemHandler_t pfnItemHandler = NULL, void *pData = NULL);
+MENU_DLL_EXPORT void Menu_MarkItemsChanged(IMenuHandle_t hMenu, IMenuItemPosition_t iFirst, IMenuItemPosition_t iLast);
 
 // See IMenu::GetCurrentPosition.
-MENU_DLL_EXPORT IMenuItemPosition_t Menu_GetCurrentPosition(IMenu_t *pMenu, CPlayerSlot aSlot);
+MENU_DLL_EXPORT IMenuItemPosition_t Menu_GetCurrentPosition(IMenuHandle_t hMenu, CPlayerSlot aSlot);
 
 // Get the currently active menu for a player.
-MENU_DLL_EXPORT IMenu_t *Menu_GetPlayerActiveMenu(IMenuSystem_t *pSystem, CPlayerSlot aSlot);
+MENU_DLL_EXPORT IMenuHandle_t Menu_GetPlayerActiveMenu(IMenuSystem_t *pSystem, CPlayerSlot aSlot);
 
 
 #endif // _INCLUDE_METAMOD_SOURCE_MENUSYSTEM_EXPORTS_H_
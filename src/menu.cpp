@@ -20,6 +20,7 @@
  */
 
 #include <menu.hpp>
+#include <menutemplate.hpp>
 #include <menu/utils.hpp>
 #include <menu/schema.hpp>
 #include <imenuhandler.hpp>
@@ -30,30 +31,40 @@
 #include <utility>
 
 #include <tier0/dbg.h>
+#include <tier1/generichash.h>
 #include <entity2/entitykeyvalues.h>
 
 const CConcatLineString g_aMenuConcat = ConcatLine_t<const char *>
 {
 	"",     // Starts with.
 	"",     // Before key.
-	". ",   // Between key & value.
-	"\n",   // Ends.
-	"\n\n"  // Ends and starts with.
+	CMenu::CLayerWriter::sm_szBetween,              // Between key & value.
+	CMenu::CLayerWriter::sm_szEnds,                 // Ends.
+	CMenu::CLayerWriter::sm_szEndsAndStartsWith     // Ends and starts with.
 };
 
-CMenu::CMenu(const CPointWorldText_Helper *pSchemaHelper, const CGameData_BaseEntity *pGameData, IMenuProfile *pProfile, IMenuHandler *pHandler, CMenuData_t::ControlItems_t *pControls)
+CMenu::CMenu(const CPointWorldText_Helper *pSchemaHelper, const CGameData_BaseEntity *pGameData, ISample *pSample, IMenuProfile *pProfile, IMenuHandler *pHandler, CMenuData_t::ControlItems_t *pControls)
  :  CMenuBase(MENU_MAX_ENTITIES),
 
     m_pSchemaHelper_PointWorldText(pSchemaHelper), 
     m_pGameData_BaseEntity(pGameData), 
+    m_pSample(pSample), 
 
     m_pProfile(pProfile), 
     m_pHandler(pHandler), 
+    m_pNextHandler(nullptr), 
 
     m_aData(pControls), 
-    m_arrCurrentPositions(Menu::Utils::MakeArrayRepeat<ItemPosition_t, ABSOLUTE_PLAYER_LIMIT + 1>(-1)), 
-    m_arrCachedPageBasesMap(Menu::Utils::MakeArrayRepeat<ItemPages_t<IPage>, ABSOLUTE_PLAYER_LIMIT + 1>(DefLessFunc(const ItemPosition_t))), 
-    m_arrCachedPagesMap(Menu::Utils::MakeArrayRepeat<ItemPages_t<IPage>, ABSOLUTE_PLAYER_LIMIT + 1>(DefLessFunc(const ItemPosition_t)))
+    m_pTemplate(nullptr), 
+    m_bTemplateDetached(false), 
+    m_bSharePages(false), 
+    m_pItemSource(nullptr), 
+    m_nContentVersion(0), 
+    m_iChangedFirst(MENU_INVALID_ITEM_POSITION), 
+    m_iChangedLast(MENU_INVALID_ITEM_POSITION), 
+    m_bViewersChanged(false), 
+    m_iPageIndexOutdatedFrom(MENU_FIRST_ITEM_INDEX), 
+    m_arrViewerIndices(Menu::Utils::MakeArrayRepeat<int8, ABSOLUTE_PLAYER_LIMIT + 1>(MENU_INVALID_VIEWER_INDEX))
 {
 }
 
@@ -97,17 +108,235 @@ void CMenu::Destroy()
 
 void CMenu::Purge()
 {
-	for(auto &mapCachedPageBases : m_arrCachedPageBasesMap)
+	RemoveAllViewers();
+	m_vecViewers.Purge();
+	ReleaseTemplate();
+	m_aPageCache.Purge();
+	ResetSentTexts();
+
+	Base::Purge();
+}
+
+void CMenu::Reset(IMenuProfile *pProfile, IMenuHandler *pHandler, CMenuData_t::ControlItems_t *pControls)
+{
+	m_pProfile = pProfile;
+	m_pHandler = pHandler;
+	m_pNextHandler = nullptr;
+	m_bvPlayers.ClearAll();
+	RemoveAllViewers();
+
+	m_aData.m_title.m_sText.Purge();
+	m_aData.m_vecItems.RemoveAll();
+	m_aData.m_eControlFlags = IMenu::MENU_ITEM_CONTROL_DEFAULT_FLAGS;
+	m_aData.m_pControlItems = pControls;
+
+	ReleaseTemplate();
+
+	m_pItemSource = nullptr;
+	m_aPageCache.RemoveAll();
+	m_iChangedFirst = m_iChangedLast = MENU_INVALID_ITEM_POSITION;
+	m_bViewersChanged = false;
+	m_iPageIndexOutdatedFrom = MENU_FIRST_ITEM_INDEX;
+	ResetSentTexts();
+
+	m_pCurrentPage = nullptr;
+
+	Base::RemoveAll();
+}
+
+bool CMenu::AddViewer(CPlayerSlot aSlot)
+{
+	if(FindViewer(aSlot))
 	{
-		mapCachedPageBases.PurgeAndDeleteElements();
+		return false;
 	}
 
-	for(auto &mapCachedPages : m_arrCachedPagesMap)
+	FindOrAddViewer(aSlot);
+
+	return true;
+}
+
+void CMenu::SetViewerPosition(CPlayerSlot aSlot, ItemPosition_t iItem)
+{
+	FindOrAddViewer(aSlot)->m_iCurrentPosition = iItem;
+}
+
+bool CMenu::RemoveViewer(CPlayerSlot aSlot)
+{
+	int iClient = aSlot.GetClientIndex();
+
+	int iViewer = m_arrViewerIndices[iClient];
+
+	if(iViewer == MENU_INVALID_VIEWER_INDEX)
 	{
-		mapCachedPages.PurgeAndDeleteElements();
+		return false;
 	}
 
-	Base::Purge();
+	delete m_vecViewers[iViewer];
+	m_vecViewers.FastRemove(iViewer);
+	m_arrViewerIndices[iClient] = MENU_INVALID_VIEWER_INDEX;
+
+	m_aPageCache.RemoveIf([iSlot = aSlot.Get()](const CPageCache::Key_t &aKey)
+	{
+		return aKey.m_iSlot == iSlot;
+	});
+
+	if(iViewer < m_vecViewers.Count()) // The last one has been moved in place.
+	{
+		m_arrViewerIndices[m_vecViewers[iViewer]->m_aSlot.GetClientIndex()] = iViewer;
+	}
+
+	return true;
+}
+
+void CMenu::RemoveAllViewers()
+{
+	for(auto *pViewer : m_vecViewers)
+	{
+		m_arrViewerIndices[pViewer->m_aSlot.GetClientIndex()] = MENU_INVALID_VIEWER_INDEX;
+
+		delete pViewer;
+	}
+
+	m_vecViewers.RemoveAll();
+}
+
+CMenu::ViewerState_t *CMenu::FindOrAddViewer(CPlayerSlot aSlot)
+{
+	int iClient = aSlot.GetClientIndex();
+
+	int iViewer = m_arrViewerIndices[iClient];
+
+	if(iViewer != MENU_INVALID_VIEWER_INDEX)
+	{
+		return m_vecViewers[iViewer];
+	}
+
+	auto *pViewer = new ViewerState_t(aSlot);
+
+	m_arrViewerIndices[iClient] = m_vecViewers.AddToTail(pViewer);
+
+	return pViewer;
+}
+
+void CMenu::AttachTemplate(CMenuTemplate *pTemplate, bool bSharePages)
+{
+	ReleaseTemplate();
+
+	pTemplate->AddRef();
+	pTemplate->Seal();
+
+	m_pTemplate = pTemplate;
+	m_bTemplateDetached = false;
+	m_bSharePages = bSharePages;
+	m_iPageIndexOutdatedFrom = MENU_FIRST_ITEM_INDEX;
+}
+
+void CMenu::DetachTemplate()
+{
+	if(!m_pTemplate || m_bTemplateDetached)
+	{
+		return;
+	}
+
+	// Pages are rendered from own data now, the template is kept for its item handlers.
+	const auto &aTemplateData = m_pTemplate->GetDataRef();
+
+	m_aData.m_title = aTemplateData.m_title;
+	m_aData.m_vecItems = aTemplateData.m_vecItems;
+	m_aData.m_eControlFlags = aTemplateData.m_eControlFlags;
+
+	m_bTemplateDetached = true;
+}
+
+void CMenu::ReleaseTemplate()
+{
+	if(m_pTemplate)
+	{
+		m_pTemplate->Release();
+		m_pTemplate = nullptr;
+	}
+
+	m_bTemplateDetached = false;
+	m_bSharePages = false;
+}
+
+IMenu::ItemPosition_t CMenu::AddItem(const Item_t &aItem)
+{
+	DetachTemplate();
+
+	auto &vecItems = m_aData.m_vecItems;
+
+	ItemPosition_t iItem = vecItems.AddToTail(aItem);
+
+	MarkItemsChanged(iItem, iItem);
+
+	return iItem;
+}
+
+bool CMenu::RemoveItem(ItemPosition_t iItem)
+{
+	DetachTemplate();
+
+	auto &vecItems = m_aData.m_vecItems;
+
+	if(!vecItems.IsValidIndex(iItem))
+	{
+		return false;
+	}
+
+	vecItems.Remove(iItem);
+	MarkItemsChanged(iItem, vecItems.Count()); // The next ones are shifted.
+
+	return true;
+}
+
+bool CMenu::SetItemContent(ItemPosition_t iItem, const char *pszContent)
+{
+	DetachTemplate();
+
+	auto &vecItems = m_aData.m_vecItems;
+
+	if(!vecItems.IsValidIndex(iItem))
+	{
+		return false;
+	}
+
+	auto &aItem = vecItems[iItem];
+
+	const bool bWasHidden = aItem.IsEmpty();
+
+	aItem.Set(pszContent);
+	MarkItemsChanged(iItem, bWasHidden == aItem.IsEmpty() ? iItem : vecItems.Count()); // Hiding one moves the next pages.
+
+	return true;
+}
+
+bool CMenu::SetItemStyle(ItemPosition_t iItem, ItemStyleFlags_t eStyle)
+{
+	DetachTemplate();
+
+	auto &vecItems = m_aData.m_vecItems;
+
+	if(!vecItems.IsValidIndex(iItem))
+	{
+		return false;
+	}
+
+	vecItems[iItem].m_eStyle = eStyle;
+	MarkItemsChanged(iItem, iItem);
+
+	return true;
+}
+
+const CMenuData_t &CMenu::GetData() const
+{
+	return m_pTemplate && !m_bTemplateDetached ? m_pTemplate->GetDataRef() : m_aData;
+}
+
+CMenuData_t &CMenu::GetData()
+{
+	return m_pTemplate && !m_bTemplateDetached ? m_pTemplate->GetDataRef() : m_aData;
 }
 
 bool CMenu::ApplyProfile(CPlayerSlot aSlot, IMenuProfile *pNewProfile)
@@ -121,6 +350,12 @@ bool CMenu::ApplyProfile(CPlayerSlot aSlot, IMenuProfile *pNewProfile)
 		return false;
 	}
 
+	// The entities are spawned by the layers, another count needs a new display.
+	if(pOldProfile && pOldProfile->GetLayers() != pNewProfile->GetLayers())
+	{
+		return false;
+	}
+
 	m_pProfile = pNewProfile;
 
 	auto vecMenuKVs = GenerateKeyValues(aSlot, g_pEntitySystem->GetEntityKeyValuesAllocator());
@@ -143,6 +378,7 @@ bool CMenu::ApplyProfile(CPlayerSlot aSlot, IMenuProfile *pNewProfile)
 void CMenu::Emit(const CUtlVector<CEntityInstance *> &vecEntites)
 {
 	CopyArray(vecEntites.Base(), vecEntites.Count());
+	ResetSentTexts(); // Pooled ones keep the texts of another menu.
 
 	auto *pHandler = GetHandler();
 
@@ -154,417 +390,1316 @@ void CMenu::Emit(const CUtlVector<CEntityInstance *> &vecEntites)
 
 inline uint8 CMenu::GetMaxItemsPerPageWithoutControls()
 {
-	auto eControlFlags = m_aData.m_eControlFlags;
+	auto eControlFlags = GetData().m_eControlFlags;
 
 	return sm_nMaxItemsPerPage - (!!(eControlFlags & MENU_ITEM_CONTROL_FLAG_BACK) + !!(eControlFlags & MENU_ITEM_CONTROL_FLAG_NEXT) + !!(eControlFlags & MENU_ITEM_CONTROL_FLAG_EXIT));
 }
 
-CMenu::IPage *CMenu::Render(CPlayerSlot aSlot, ItemPosition_t iStartItem, DisplayFlags_t eFlags)
+void CMenu::MarkContentChanged()
 {
-	int iClient = aSlot.GetClientIndex();
+	m_nContentVersion++;
+	m_aPageCache.RemoveAll(); // Unreachable with the old version.
+	m_iPageIndexOutdatedFrom = MENU_FIRST_ITEM_INDEX;
+}
+
+void CMenu::MarkItemsChanged(ItemPosition_t iFirst, ItemPosition_t iLast)
+{
+	if(m_iChangedFirst == MENU_INVALID_ITEM_POSITION)
+	{
+		m_iChangedFirst = iFirst;
+		m_iChangedLast = iLast;
+
+		return;
+	}
+
+	m_iChangedFirst = MIN(m_iChangedFirst, iFirst);
+	m_iChangedLast = MAX(m_iChangedLast, iLast);
+}
 
-	auto &mapCachedPages = (eFlags & MENU_DISPLAY_RENDER_BASE ? m_arrCachedPageBasesMap : m_arrCachedPagesMap)[iClient];
+void CMenu::ApplyItemChanges()
+{
+	if(m_iChangedFirst == MENU_INVALID_ITEM_POSITION)
+	{
+		return;
+	}
 
-	auto iFoundPage = mapCachedPages.Find(iStartItem);
+	const ItemPosition_t iFirst = m_iChangedFirst, 
+	                     iLast = m_iChangedLast;
 
-	IPage *pPage = iFoundPage == mapCachedPages.InvalidIndex() ? nullptr : mapCachedPages.Element(iFoundPage);
+	m_iChangedFirst = m_iChangedLast = MENU_INVALID_ITEM_POSITION;
 
-	if(pPage)
+	// By the bounds the pages were rendered with, before the index is rebuilt.
+	for(auto *pViewer : m_vecViewers)
 	{
-		if(eFlags & MENU_DISPLAY_RERENDER)
+		if(pViewer->m_bItemsChanged || pViewer->m_iCurrentPosition < 0 || !m_bvPlayers.IsBitSet(pViewer->m_aSlot.Get()))
 		{
-			pPage->Render(static_cast<IMenu *>(this), m_aData, aSlot, iStartItem, GetMaxItemsPerPageWithoutControls());
+			continue;
+		}
+
+		if(m_iPageIndexOutdatedFrom == MENU_INVALID_ITEM_POSITION)
+		{
+			int iPage = pViewer->m_iCurrentPage;
+
+			if(!m_aPageIndex.HasItem(iPage, pViewer->m_iCurrentPosition))
+			{
+				iPage = m_aPageIndex.FindPage(pViewer->m_iCurrentPosition);
+			}
+
+			if(!IsPageChanged(m_aPageIndex.GetBounds(iPage), iFirst, iLast))
+			{
+				continue;
+			}
 		}
+
+		pViewer->m_bItemsChanged = true;
+		m_bViewersChanged = true;
+	}
+
+	if(m_iPageIndexOutdatedFrom != MENU_INVALID_ITEM_POSITION)
+	{
+		m_aPageCache.RemoveAll(); // Bounds of the cached pages are unknown.
 	}
 	else
 	{
-		const int nMessageTextSize = m_pSchemaHelper_PointWorldText->GetMessageTextSize();
+		const auto &aPageIndex = m_aPageIndex;
+
+		m_aPageCache.RemoveIf([&](const CPageCache::Key_t &aKey)
+		{
+			return IsPageChanged(aPageIndex.GetBounds(aPageIndex.FindPage(aKey.m_iStartItem)), iFirst, iLast);
+		});
+	}
+
+	m_iPageIndexOutdatedFrom = m_iPageIndexOutdatedFrom == MENU_INVALID_ITEM_POSITION ? iFirst : MIN(m_iPageIndexOutdatedFrom, iFirst);
+}
+
+int CMenu::FlushItemChanges()
+{
+	// The viewers are marked by the first page query after a change, this one or any other.
+	ApplyItemChanges();
+
+	if(!m_bViewersChanged)
+	{
+		return 0;
+	}
 
-		pPage = static_cast<IPage *>(eFlags & MENU_DISPLAY_RENDER_BASE ? new CPageBase(nMessageTextSize) : new CPage(nMessageTextSize));
+	m_bViewersChanged = false;
+
+	CUtlVector<ViewerState_t *> vecChangedViewers;
+
+	for(auto *pViewer : m_vecViewers)
+	{
+		if(pViewer->m_bItemsChanged)
+		{
+			pViewer->m_bItemsChanged = false;
 
-		Assert(pPage);
-		pPage->Render(static_cast<IMenu *>(this), m_aData, aSlot, iStartItem, GetMaxItemsPerPageWithoutControls());
-		mapCachedPages.Insert(iStartItem, pPage);
+			if(pViewer->m_iCurrentPosition >= 0)
+			{
+				vecChangedViewers.AddToTail(pViewer);
+			}
+		}
 	}
 
-	m_arrCurrentPositions[iClient] = iStartItem;
+	// Render snaps the old positions to the pages of the new items.
+	for(auto *pViewer : vecChangedViewers)
+	{
+		InternalDisplayAt(pViewer->m_aSlot, pViewer->m_iCurrentPosition, static_cast<DisplayFlags_t>(pViewer->m_eLastDisplayFlags & ~MENU_DISPLAY_RERENDER));
+	}
 
-	return pPage;
+	return vecChangedViewers.Count();
 }
 
-bool CMenu::InternalDisplayAt(CPlayerSlot aSlot, ItemPosition_t iStartItem, DisplayFlags_t eFlags)
+const CMenu::CPageIndex &CMenu::GetPageIndex()
 {
-	m_bvPlayers.Set(aSlot.Get());
+	ApplyItemChanges();
 
-	auto *pPage = Render(aSlot, iStartItem, eFlags);
+	const uint8 nMaxItems = GetMaxItemsPerPageWithoutControls();
 
-	if(eFlags & MENU_DISPLAY_UPDATE_TEXT_NOW)
+	if(m_aPageIndex.GetMaxItems() != nMaxItems)
 	{
-		InternalSetMessage(MENU_ENTITY_BACKGROUND_INDEX, pPage->GetText());
-		InternalSetMessage(MENU_ENTITY_INACTIVE_INDEX, pPage->GetInactiveText());
-		InternalSetMessage(MENU_ENTITY_ACTIVE_INDEX, pPage->GetActiveText());
-		InternalSetMessage(MENU_ENTITY_DISABLED_ACTIVE_INDEX, pPage->GetDisabledActiveText());
+		m_iPageIndexOutdatedFrom = MENU_FIRST_ITEM_INDEX;
 	}
 
-	return true;
+	if(m_pItemSource)
+	{
+		m_aPageIndex.BuildUniform(m_pItemSource->GetItemCount(static_cast<IMenu *>(this)), nMaxItems); // The count can change at any time.
+		m_iPageIndexOutdatedFrom = MENU_INVALID_ITEM_POSITION;
+	}
+	else if(m_iPageIndexOutdatedFrom != MENU_INVALID_ITEM_POSITION)
+	{
+		m_aPageIndex.Build(GetData().m_vecItems, nMaxItems, m_iPageIndexOutdatedFrom);
+		m_iPageIndexOutdatedFrom = MENU_INVALID_ITEM_POSITION;
+	}
+
+	return m_aPageIndex;
 }
 
-bool CMenu::OnSelect(CPlayerSlot aSlot, int iSlectedItem, DisplayFlags_t eFlags)
+int CMenu::FindPageNumber(const ViewerState_t *pViewer, ItemPosition_t iItem)
 {
+	const auto &aPageIndex = GetPageIndex();
 
-	if(iSlectedItem == -1)
+	if(pViewer)
 	{
-		return false;
+		const int iPage = pViewer->m_iCurrentPage;
+
+		for(int iHint : {iPage, iPage + 1, iPage - 1}) // Back and next.
+		{
+			if(aPageIndex.HasItem(iHint, iItem))
+			{
+				return iHint;
+			}
+		}
 	}
 
-	const uint8 nMaxItemsPerPage = GetMaxItemsPerPageWithoutControls();
+	return aPageIndex.FindPage(iItem);
+}
 
-	const bool bIsNullableItem = !iSlectedItem, 
-	           bIsAboveItem = iSlectedItem > nMaxItemsPerPage;
+int CMenu::GetPageCount()
+{
+	return GetPageIndex().Count();
+}
 
-	auto eControlFlags = m_aData.m_eControlFlags;
+IMenu::ItemPosition_t CMenu::GetPageStartItem(int iPage)
+{
+	const auto &aPageIndex = GetPageIndex();
 
-	const bool bHasBackButton = !!(eControlFlags & MENU_ITEM_CONTROL_FLAG_BACK), 
-	           bHasNextButton = !!(eControlFlags & MENU_ITEM_CONTROL_FLAG_NEXT), 
-	           bHasExitButton = !!(eControlFlags & MENU_ITEM_CONTROL_FLAG_EXIT);
+	return 0 <= iPage && iPage < aPageIndex.Count() ? aPageIndex.GetStartItem(iPage) : MENU_INVALID_ITEM_POSITION;
+}
 
-	const uint8 nControlsSum = bHasBackButton + bHasNextButton + bHasExitButton;
+int CMenu::GetPageOfItem(ItemPosition_t iItem)
+{
+	return GetPageIndex().FindPage(iItem);
+}
 
-	ItemPosition_t iTargetItem {};
+void CMenu::SetItemSource(IItemSource *pSource)
+{
+	m_pItemSource = pSource;
+	MarkContentChanged();
+}
 
-	ItemPosition_t iStartItem = GetCurrentPosition(aSlot);
+bool CMenu::IsRenderSlotSpecific(CPlayerSlot aSlot)
+{
+	auto *pHandler = GetHandler();
 
-	ItemPositionOnPage_t iItemOnPage = static_cast<ItemPosition_t>(iSlectedItem - nMaxItemsPerPage);
+	return pHandler && pHandler->IsMenuRenderSlotSpecific(static_cast<IMenu *>(this), aSlot);
+}
 
-	if(bIsNullableItem)
+CMenu::CPageCache &CMenu::FindPageCache(bool bSlotSpecific)
+{
+	if(!bSlotSpecific && !m_pItemSource && m_pTemplate && !m_bTemplateDetached && m_bSharePages)
 	{
-		iTargetItem = MENU_ITEM_CONTROL_EXIT_INDEX;
+		return m_pTemplate->GetPageCache();
 	}
-	else if(bIsAboveItem)
+
+	return m_aPageCache;
+}
+
+const IMenu::Items_t &CMenu::LoadPageItems(PageBounds_t &aBounds, Items_t &vecStorage)
+{
+	if(!m_pItemSource)
 	{
-		iTargetItem = static_cast<ItemControls_t>(-iItemOnPage);
+		return GetData().m_vecItems;
 	}
-	else
+
+	const ItemPosition_t nCount = aBounds.m_iEndItem - aBounds.m_iStartItem;
+
+	m_pItemSource->GetItems(static_cast<IMenu *>(this), aBounds.m_iStartItem, nCount, vecStorage);
+
+	// One per position, the missing ones are hidden.
+	while(vecStorage.Count() < nCount)
 	{
-		iTargetItem = iStartItem + iSlectedItem - 1;
+		vecStorage.AddToTail(Item_t(""));
 	}
 
-	auto &vecItems = m_aData.m_vecItems;
+	aBounds.m_pItems = &vecStorage;
 
-	if(bIsNullableItem || bIsAboveItem) // Is control
-	{
-		switch(iTargetItem)
-		{
-			case MENU_ITEM_CONTROL_BACK_INDEX:
-			{
-				ItemPosition_t iPrevItems = iStartItem - nMaxItemsPerPage;
+	return vecStorage;
+}
 
-				if(iPrevItems >= 0)
-				{
-					InternalDisplayAt(aSlot, iPrevItems, eFlags);
-				}
+CMenu::CPageCache::Key_t CMenu::MakePageKey(CPlayerSlot aSlot, ItemPosition_t iStartItem, bool bIsBase, bool bSlotSpecific) const
+{
+	auto *pPlayer = aSlot.IsValid() ? m_pSample->GetPlayerBase(aSlot) : nullptr;
 
-				break;
-			}
+	const auto &aData = GetData();
 
-			case MENU_ITEM_CONTROL_NEXT_INDEX:
-			{
-				ItemPosition_t iNextItems = iStartItem + nMaxItemsPerPage;
+	return {m_pTemplate && !m_bTemplateDetached ? 0 : m_nContentVersion, iStartItem, pPlayer ? pPlayer->GetLanguage() : nullptr, aData.m_eControlFlags, bIsBase, bSlotSpecific ? aSlot.Get() : -1, GetLayerMask()};
+}
 
-				if(iNextItems < vecItems.Count())
-				{
-					InternalDisplayAt(aSlot, iNextItems, eFlags);
-				}
+CMenu::IPage *CMenu::RenderPage(CPlayerSlot aSlot, int iPage, bool bIsBase, bool bRerender)
+{
+	const auto aBounds = GetPageIndex().GetBounds(iPage);
 
-				break;
-			}
-		}
-	}
+	const bool bSlotSpecific = IsRenderSlotSpecific(aSlot);
 
-	// DEBUG: Check if target item is valid
-	if(0 <= iTargetItem && iTargetItem < vecItems.Count())
-	{
-		auto &aItem = vecItems[iTargetItem];
+	auto &aPageCache = FindPageCache(bSlotSpecific);
 
-		if (!(aItem.GetStyle() & IMenu::MENU_ITEM_ACTIVE))
-		{
-			return false;
-		}
+	const auto aKey = MakePageKey(aSlot, aBounds.m_iStartItem, bIsBase, bSlotSpecific);
 
-		auto *pItemHandler = aItem.m_pHandler;
+	IPage *pPage = aPageCache.Find(aKey);
 
-		if(pItemHandler)
+	if(pPage && bRerender)
+	{
+		aPageCache.Remove(aKey); // The texts are not rewritten in place.
+		pPage = nullptr;
+	}
+
+	if(!pPage)
+	{
+		pPage = RenderNewPage(aSlot, aBounds, bIsBase, aPageCache, aKey);
+	}
+
+	return pPage;
+}
+
+CMenu::IPage *CMenu::RenderNewPage(CPlayerSlot aSlot, PageBounds_t aBounds, bool bIsBase, CPageCache &aPageCache, const CPageCache::Key_t &aKey, bool bPrerendered)
+{
+	const int nMessageTextSize = m_pSchemaHelper_PointWorldText->GetMessageTextSize();
+
+	IPage *pPage = static_cast<IPage *>(bIsBase ? new CPageBase(nMessageTextSize) : new CPage(nMessageTextSize, GetLayerMask()));
+
+	Items_t vecPageItems;
+
+	LoadPageItems(aBounds, vecPageItems);
+
+	Assert(pPage);
+	pPage->Render(static_cast<IMenu *>(this), GetData(), aSlot, aBounds, aPageCache.GetArena());
+	aPageCache.Insert(aKey, pPage, bPrerendered);
+
+	return pPage;
+}
+
+bool CMenu::PrerenderAdjacentPage(CPlayerSlot aSlot, int iOffset)
+{
+	const auto *pViewer = FindViewer(aSlot);
+
+	if(!pViewer || pViewer->m_iCurrentPosition < 0)
+	{
+		return false;
+	}
+
+	const auto &aPageIndex = GetPageIndex();
+
+	const int iPage = FindPageNumber(pViewer, pViewer->m_iCurrentPosition) + iOffset;
+
+	if(iPage < 0 || iPage >= aPageIndex.Count())
+	{
+		return false;
+	}
+
+	const auto aBounds = aPageIndex.GetBounds(iPage);
+
+	const bool bIsBase = !!(pViewer->m_eLastDisplayFlags & MENU_DISPLAY_RENDER_BASE), 
+	           bSlotSpecific = IsRenderSlotSpecific(aSlot);
+
+	auto &aPageCache = FindPageCache(bSlotSpecific);
+
+	const auto aKey = MakePageKey(aSlot, aBounds.m_iStartItem, bIsBase, bSlotSpecific);
+
+	if(aPageCache.HasPage(aKey))
+	{
+		return false;
+	}
+
+	RenderNewPage(aSlot, aBounds, bIsBase, aPageCache, aKey, true);
+
+	return true;
+}
+
+CMenu::IPage *CMenu::Render(CPlayerSlot aSlot, ItemPosition_t iStartItem, DisplayFlags_t eFlags)
+{
+	auto *pViewer = FindOrAddViewer(aSlot);
+
+	const int iPage = FindPageNumber(pViewer, iStartItem); // Snaps to the start of the page.
+
+	IPage *pPage = RenderPage(aSlot, iPage, !!(eFlags & MENU_DISPLAY_RENDER_BASE), !!(eFlags & MENU_DISPLAY_RERENDER));
+
+	pViewer->m_iCurrentPosition = GetPageIndex().GetStartItem(iPage);
+	pViewer->m_iCurrentPage = iPage;
+	pViewer->m_eLastDisplayFlags = eFlags;
+
+	return pPage;
+}
+
+bool CMenu::InternalDisplayAt(CPlayerSlot aSlot, ItemPosition_t iStartItem, DisplayFlags_t eFlags)
+{
+	m_bvPlayers.Set(aSlot.Get());
+
+	auto *pPage = Render(aSlot, iStartItem, eFlags);
+
+	if(eFlags & MENU_DISPLAY_UPDATE_TEXT_NOW)
+	{
+		const auto nLayers = GetLayerMask();
+
+		int iEntity = 0;
+
+		for(int i = 0; i < MENU_MAX_ENTITIES; i++)
+		{
+			if(nLayers & (1 << i))
+			{
+				InternalSetMessage(iEntity++, GetPageLayerText(pPage, static_cast<MenuEntity_t>(i)));
+			}
+		}
+	}
+
+	return true;
+}
+
+bool CMenu::OnSelect(CPlayerSlot aSlot, int iSlectedItem, DisplayFlags_t eFlags)
+{
+
+	if(iSlectedItem == -1)
+	{
+		return false;
+	}
+
+	const uint8 nMaxItemsPerPage = GetMaxItemsPerPageWithoutControls();
+
+	const bool bIsNullableItem = !iSlectedItem, 
+	           bIsAboveItem = iSlectedItem > nMaxItemsPerPage;
+
+	auto &aData = GetData();
+
+	auto eControlFlags = aData.m_eControlFlags;
+
+	const bool bHasBackButton = !!(eControlFlags & MENU_ITEM_CONTROL_FLAG_BACK), 
+	           bHasNextButton = !!(eControlFlags & MENU_ITEM_CONTROL_FLAG_NEXT), 
+	           bHasExitButton = !!(eControlFlags & MENU_ITEM_CONTROL_FLAG_EXIT);
+
+	const uint8 nControlsSum = bHasBackButton + bHasNextButton + bHasExitButton;
+
+	ItemPosition_t iTargetItem {};
+
+	const int iPage = FindPageNumber(FindViewer(aSlot), GetCurrentPosition(aSlot));
+
+	const auto &aPageIndex = GetPageIndex();
+
+	auto aBounds = aPageIndex.GetBounds(iPage);
+
+	Items_t vecPageItems;
+
+	const auto &vecItems = LoadPageItems(aBounds, vecPageItems);
+
+	const ItemPosition_t iItemsBase = aBounds.m_pItems ? aBounds.m_iStartItem : MENU_FIRST_ITEM_INDEX, 
+	                     iItemsEnd = MIN(aBounds.m_iEndItem, iItemsBase + vecItems.Count()); // A source may give less than the page bounds.
+
+	ItemPositionOnPage_t iItemOnPage = static_cast<ItemPosition_t>(iSlectedItem - nMaxItemsPerPage);
+
+	if(bIsNullableItem)
+	{
+		iTargetItem = MENU_ITEM_CONTROL_EXIT_INDEX;
+	}
+	else if(bIsAboveItem)
+	{
+		iTargetItem = static_cast<ItemControls_t>(-iItemOnPage);
+	}
+	else
+	{
+		iTargetItem = aPageIndex.GetEndItem(aPageIndex.Count() - 1); // Out of the items, as a selection under them.
+
+		// Numbered by the shown items of the page.
+		for(ItemPosition_t i = aBounds.m_iStartItem, nShown = 0; i < iItemsEnd; i++)
+		{
+			if(!vecItems[i - iItemsBase].IsEmpty() && ++nShown == iSlectedItem)
+			{
+				iTargetItem = i;
+
+				break;
+			}
+		}
+	}
+
+	if(bIsNullableItem || bIsAboveItem) // Is control
+	{
+		switch(iTargetItem)
+		{
+			case MENU_ITEM_CONTROL_BACK_INDEX:
+			{
+				if(iPage > 0)
+				{
+					InternalDisplayAt(aSlot, aPageIndex.GetStartItem(iPage - 1), eFlags);
+				}
+
+				break;
+			}
+
+			case MENU_ITEM_CONTROL_NEXT_INDEX:
+			{
+				if(iPage + 1 < aPageIndex.Count())
+				{
+					InternalDisplayAt(aSlot, aPageIndex.GetStartItem(iPage + 1), eFlags);
+				}
+
+				break;
+			}
+		}
+	}
+
+	if(aBounds.m_iStartItem <= iTargetItem && iTargetItem < iItemsEnd)
+	{
+		const auto &aItem = vecItems[iTargetItem - iItemsBase];
+
+		if (!(aItem.GetStyle() & IMenu::MENU_ITEM_ACTIVE))
+		{
+			return false;
+		}
+
+		auto *pItemHandler = aItem.m_pHandler;
+
+		if(pItemHandler)
 		{
 			pItemHandler->OnMenuSelectItem(static_cast<IMenu *>(this), aSlot, iTargetItem, iItemOnPage, aItem.m_pData);
 		}
 	}
 
-	auto *pHandler = GetHandler();
+	auto *pHandler = GetHandler();
+
+	if(pHandler)
+	{
+		pHandler->OnMenuSelect(static_cast<IMenu *>(this), aSlot, iTargetItem);
+	}
+
+	return true;
+}
+
+CEntityKeyValues *CMenu::GetAllocatedBackgroundKeyValues(CPlayerSlot aSlot, CKeyValues3Context *pAllocator)
+{
+	const IMenuProfile *pProfile = m_pProfile;
+
+	Assert(pProfile);
+
+	CEntityKeyValues *pMenuKV = pProfile->GetAllocactedEntityKeyValues(pAllocator);
+
+	if(pMenuKV)
+	{
+		const Color *pBackgrounndColor = pProfile->GetBackgroundColor();
+
+		if(pBackgrounndColor)
+		{
+			pMenuKV->SetColor("color", *pBackgrounndColor);
+		}
+		else
+		{
+			const Color *pInactiveColor = pProfile->GetInactiveColor(), 
+			            *pActiveColor = pProfile->GetActiveColor();
+	
+			if(pInactiveColor && pActiveColor)
+			{
+				pMenuKV->SetColor("color", CalculatePassiveColor(*pInactiveColor, *pActiveColor));
+			}
+		}
+
+
+		pMenuKV->SetString("message", GetCurrentPage(aSlot)->GetText());
+	}
+
+	return pMenuKV;
+}
+
+CEntityKeyValues *CMenu::GetAllocatedInactiveKeyValues(CPlayerSlot aSlot, CKeyValues3Context *pAllocator, bool bDrawBackground)
+{
+	const IMenuProfile *pProfile = m_pProfile;
+
+	Assert(pProfile);
+
+	CEntityKeyValues *pMenuKV = pProfile->GetAllocactedEntityKeyValues(pAllocator);
+
+	if(pMenuKV)
+	{
+		const Color *pInactiveColor = pProfile->GetInactiveColor();
+
+		if(pInactiveColor)
+		{
+			pMenuKV->SetColor("color", *pInactiveColor);
+		}
+
+		if(bDrawBackground)
+		{
+			pMenuKV->SetString("background_material_name", MENU_EMPTY_BACKGROUND_MATERIAL_NAME); // To align with the background.
+		}
+
+		pMenuKV->SetString("message", GetCurrentPage(aSlot)->GetInactiveText());
+	}
+
+	return pMenuKV;
+}
+
+CEntityKeyValues *CMenu::GetAllocatedActiveKeyValues(CPlayerSlot aSlot, CKeyValues3Context *pAllocator, bool bDrawBackground)
+{
+	const IMenuProfile *pProfile = m_pProfile;
+
+	Assert(pProfile);
+
+	CEntityKeyValues *pMenuKV = pProfile->GetAllocactedEntityKeyValues(pAllocator);
+
+	if(pMenuKV)
+	{
+		const Color *pActiveColor = pProfile->GetActiveColor();
+
+		if(pActiveColor)
+		{
+			pMenuKV->SetColor("color", *pActiveColor);
+		}
+
+		if(bDrawBackground)
+		{
+			pMenuKV->SetString("background_material_name", MENU_EMPTY_BACKGROUND_MATERIAL_NAME); // To align with the background.
+		}
+
+		pMenuKV->SetString("message", GetCurrentPage(aSlot)->GetActiveText());
+	}
+
+	return pMenuKV;
+}
+
+CEntityKeyValues *CMenu::GetAllocatedDisabledActiveKeyValues(CPlayerSlot aSlot, CKeyValues3Context *pAllocator, bool bDrawBackground)
+{
+	const IMenuProfile *pProfile = m_pProfile;
+
+	Assert(pProfile);
+
+	CEntityKeyValues *pMenuKV = pProfile->GetAllocactedEntityKeyValues(pAllocator);
+
+	if(pMenuKV)
+	{
+		const Color *pColor = pProfile->GetDisabledActiveColor();
+
+		if(pColor)
+		{
+			pMenuKV->SetColor("color", *pColor);
+		}
+
+		if(bDrawBackground)
+		{
+			pMenuKV->SetString("background_material_name", MENU_EMPTY_BACKGROUND_MATERIAL_NAME); // To align with the background.
+		}
+
+		pMenuKV->SetString("message", GetCurrentPage(aSlot)->GetDisabledActiveText());
+	}
+
+	return pMenuKV;
+}
+
+CUtlVector<CEntityKeyValues *> CMenu::GenerateKeyValues(CPlayerSlot aSlot, CKeyValues3Context *pAllocator, bool bIncludeBackground)
+{
+	Render(aSlot);
+
+	const auto nLayers = GetLayerMask();
+
+	CUtlVector<CEntityKeyValues *> vecResult(MENU_MAX_ENTITIES);
+
+	vecResult.AddToTail(bIncludeBackground ? GetAllocatedBackgroundKeyValues(aSlot, pAllocator) : nullptr);
+
+	if(nLayers & CLayerWriter::MENU_LAYER_INACTIVE)
+	{
+		vecResult.AddToTail(GetAllocatedInactiveKeyValues(aSlot, pAllocator, bIncludeBackground));
+	}
+
+	vecResult.AddToTail(GetAllocatedActiveKeyValues(aSlot, pAllocator, bIncludeBackground));
+
+	if(nLayers & CLayerWriter::MENU_LAYER_DISABLED_ACTIVE)
+	{
+		vecResult.AddToTail(GetAllocatedDisabledActiveKeyValues(aSlot, pAllocator, bIncludeBackground));
+	}
+
+	return vecResult;
+}
+
+CMenu::CLayerWriter::LayerMask_t CMenu::GetLayerMask() const
+{
+	const IMenuProfile *pProfile = m_pProfile;
+
+	switch(pProfile ? pProfile->GetLayers() : MENU_PROFILE_MAX_LAYERS)
+	{
+		case MENU_PROFILE_MIN_LAYERS:
+			return CLayerWriter::MENU_LAYER_TEXT | CLayerWriter::MENU_LAYER_ACTIVE;
+
+		case MENU_PROFILE_MERGED_LAYERS:
+			return CLayerWriter::MENU_LAYER_TEXT | CLayerWriter::MENU_LAYER_INACTIVE | CLayerWriter::MENU_LAYER_ACTIVE;
+
+		default:
+			return CLayerWriter::MENU_LAYER_ALL;
+	}
+}
+
+CEntityInstance *CMenu::GetLayerEntity(MenuEntity_t eLayer) const
+{
+	const auto nLayers = GetLayerMask();
+
+	if(!(nLayers & (1 << eLayer)))
+	{
+		return nullptr;
+	}
+
+	int iEntity = 0;
+
+	for(int i = 0; i < eLayer; i++)
+	{
+		iEntity += !!(nLayers & (1 << i));
+	}
+
+	const auto &vecEntities = GetActiveEntities();
+
+	return iEntity < vecEntities.Count() ? vecEntities[iEntity] : nullptr;
+}
+
+const char *CMenu::GetPageLayerText(const IPage *pPage, MenuEntity_t eLayer)
+{
+	switch(eLayer)
+	{
+		case MENU_ENTITY_BACKGROUND_INDEX:
+			return pPage->GetText();
+
+		case MENU_ENTITY_INACTIVE_INDEX:
+			return pPage->GetInactiveText();
+
+		case MENU_ENTITY_ACTIVE_INDEX:
+			return pPage->GetActiveText();
+
+		default:
+			return pPage->GetDisabledActiveText();
+	}
+}
+
+Color CMenu::CalculatePassiveColor(const Color &rgbaActive, const Color &rgbaInactive)
+{
+	struct BackgroundColor_t
+	{
+		uint16 _r_sum;
+		uint16 _g_sum;
+		uint16 _b_sum;
+		uint16 _a_sum;
+
+		BackgroundColor_t() = delete;
+		inline BackgroundColor_t(const Color &left, const Color &right)
+		 :  _r_sum(left.r() + right.r()),
+		    _g_sum(left.g() + right.g()),
+		    _b_sum(left.b() + right.b()),
+		    _a_sum(left.a() + right.a())
+		{
+		}
+
+		inline Color GetPassiveColor()
+		{
+			return {_r_sum / 3, _g_sum / 3, _b_sum / 3, _a_sum / 3};
+		}
+	};
+
+	return BackgroundColor_t(rgbaActive, rgbaInactive).GetPassiveColor();
+}
+
+void CMenu::InternalSetMessage(int iEntity, const char *pszText)
+{
+	Assert(0 <= iEntity && iEntity < Count());
+
+	auto *pEntity = Element(iEntity);
+
+	auto &aSentText = m_arrSentTexts[iEntity];
+
+	const int nLength = V_strlen(pszText);
+
+	const uint32 nHash = MurmurHash2(pszText, nLength, MENU_SENT_TEXT_HASH_SEED);
+
+	auto *pPointWorldTextEntity = instance_upper_cast<CPointWorldText *>(pEntity);
+
+	auto aTextAccessor = m_pSchemaHelper_PointWorldText->GetMessageTextAccessor(pPointWorldTextEntity);
+
+	// The same text to the same entity is neither copied nor networked again. 
+	// A hash match is confirmed by the entity message, which holds the text truncated to its size.
+	if(aSentText.m_pEntity == pEntity && aSentText.m_nLength == nLength && aSentText.m_nHash == nHash && 
+	   !V_strncmp(aTextAccessor, pszText, static_cast<int>(aTextAccessor.GetSize()) - 1))
+	{
+		return;
+	}
+
+	V_strncpy(aTextAccessor, pszText, aTextAccessor.GetSize());
+	aTextAccessor.MarkNetworkChanged();
+
+	aSentText = {pEntity, nHash, nLength};
+}
+
+CMenu::CLayerWriter::CLayerWriter(CBufferStringText *const *ppLayers, int nLayers, int nCapacity, LayerMask_t nWrittenLayers)
+ :  m_ppLayers(ppLayers), 
+    m_nLayers(nLayers), 
+    m_nWrittenLayers(nWrittenLayers), 
+    m_nCapacity(nCapacity)
+{
+	Assert(nLayers <= MENU_MAX_ENTITIES);
+
+	for(int i = 0; i < nLayers; i++)
+	{
+		m_arrLengths[i] = ppLayers[i]->Length();
+	}
+}
+
+void CMenu::CLayerWriter::AppendEnds(LayerMask_t nLayers)
+{
+	nLayers &= m_nWrittenLayers;
+
+	for(int i = 0; i < m_nLayers; i++)
+	{
+		if(nLayers & (1 << i))
+		{
+			Write(i, sm_szEnds, sizeof(sm_szEnds) - 1);
+		}
+	}
+}
+
+void CMenu::CLayerWriter::AppendEndsAndStartsWith(LayerMask_t nLayers)
+{
+	nLayers &= m_nWrittenLayers;
+
+	for(int i = 0; i < m_nLayers; i++)
+	{
+		if(nLayers & (1 << i))
+		{
+			Write(i, sm_szEndsAndStartsWith, sizeof(sm_szEndsAndStartsWith) - 1);
+		}
+	}
+}
+
+void CMenu::CLayerWriter::AppendLine(LayerMask_t nLineLayers, const char *pszNumber, const char *pszContent, int nContentLength)
+{
+	char szLine[MENU_MAX_TEXT_LENGTH];
+
+	int nLineLength = 0;
+
+	auto Put = [&](const char *pszText, int nLength)
+	{
+		nLength = MIN(nLength, static_cast<int>(sizeof(szLine)) - 1 - nLineLength);
+
+		if(nLength > 0)
+		{
+			V_memcpy(&szLine[nLineLength], pszText, nLength);
+			nLineLength += nLength;
+		}
+	};
+
+	// Built once for all layers, the same as CConcatLineBuffer::Append() with g_aMenuConcat.
+	if(pszNumber)
+	{
+		Put(pszNumber, V_strlen(pszNumber));
+		Put(sm_szBetween, sizeof(sm_szBetween) - 1);
+	}
+
+	Put(pszContent, nContentLength < 0 ? V_strlen(pszContent) : nContentLength);
+	Put(sm_szEnds, sizeof(sm_szEnds) - 1);
+
+	nLineLayers = MergeLayers(nLineLayers);
+
+	for(int i = 0; i < m_nLayers; i++)
+	{
+		if(!(m_nWrittenLayers & (1 << i)))
+		{
+			continue;
+		}
+
+		if(nLineLayers & (1 << i))
+		{
+			Write(i, szLine, nLineLength);
+		}
+		else
+		{
+			Write(i, sm_szEnds, sizeof(sm_szEnds) - 1);
+		}
+	}
+}
+
+CMenu::CLayerWriter::LayerMask_t CMenu::CLayerWriter::MergeLayers(LayerMask_t nLineLayers) const
+{
+	// The disabled active lines cover the inactive ones, so the merged layer takes them all.
+	if((nLineLayers & MENU_LAYER_DISABLED_ACTIVE) && !(m_nWrittenLayers & MENU_LAYER_DISABLED_ACTIVE))
+	{
+		nLineLayers |= MENU_LAYER_INACTIVE;
+	}
+
+	return nLineLayers;
+}
+
+void CMenu::CLayerWriter::Write(int iLayer, const char *pszText, int nLength)
+{
+	int &nLayerLength = m_arrLengths[iLayer];
+
+	nLength = MIN(nLength, m_nCapacity - 1 - nLayerLength);
+
+	if(nLength <= 0)
+	{
+		return;
+	}
+
+	m_ppLayers[iLayer]->Append(pszText, nLength);
+	nLayerLength += nLength;
+}
+
+void CMenu::CPageIndex::Build(const Items_t &vecItems, uint8 nMaxItems, ItemPosition_t iFromItem)
+{
+	Assert(nMaxItems);
+
+	int iPage = 0;
+
+	// Hiding the start item of a page moves it, so the previous page is built again too.
+	if(!m_bUniform && nMaxItems == m_nMaxItems && Count())
+	{
+		iPage = MAX(FindPage(iFromItem) - 1, 0);
+	}
+
+	ItemPosition_t i = iPage ? GetStartItem(iPage) : MENU_FIRST_ITEM_INDEX;
+
+	m_vecStartItems.SetCountNonDestructively(iPage);
+	m_vecStartItems.AddToTail(i);
+	m_nItems = vecItems.Count();
+	m_nMaxItems = nMaxItems;
+	m_bUniform = false;
+
+	int nShown = 0;
+
+	for(; i < m_nItems; i++)
+	{
+		if(vecItems[i].IsEmpty())
+		{
+			continue;
+		}
+
+		if(nShown == nMaxItems)
+		{
+			m_vecStartItems.AddToTail(i);
+			nShown = 0;
+		}
+
+		nShown++;
+	}
+}
+
+void CMenu::CPageIndex::BuildUniform(ItemPosition_t nItems, uint8 nMaxItems)
+{
+	Assert(nMaxItems);
+
+	m_vecStartItems.RemoveAll();
+	m_nItems = MAX(nItems, 0);
+	m_nMaxItems = nMaxItems;
+	m_bUniform = true;
+}
+
+int CMenu::CPageIndex::FindPage(ItemPosition_t iItem) const
+{
+	if(m_bUniform)
+	{
+		return MIN(MAX(iItem / m_nMaxItems, 0), Count() - 1);
+	}
+
+	// The last page with the start item not after the item.
+	int iLow = 0, 
+	    iHigh = Count() - 1;
+
+	while(iLow < iHigh)
+	{
+		int iMiddle = (iLow + iHigh + 1) / 2;
+
+		if(m_vecStartItems[iMiddle] <= iItem)
+		{
+			iLow = iMiddle;
+		}
+		else
+		{
+			iHigh = iMiddle - 1;
+		}
+	}
+
+	return MAX(iLow, 0);
+}
+
+CMenu::CPageArena::CPageArena()
+ :  m_iCurrentBlock(-1), 
+    m_nBlockUsed(sm_nBlockSize), 
+    m_nUsedBytes(0)
+{
+}
+
+CMenu::CPageArena::~CPageArena()
+{
+	Purge();
+}
+
+const char *CMenu::CPageArena::Store(const char *pszText, int nLength)
+{
+	const int nSize = nLength + 1;
+
+	Assert(nSize <= sm_nBlockSize);
+
+	if(m_nBlockUsed + nSize > sm_nBlockSize)
+	{
+		if(++m_iCurrentBlock == m_vecBlocks.Count())
+		{
+			m_vecBlocks.AddToTail(new char[sm_nBlockSize]);
+		}
+
+		m_nBlockUsed = 0;
+	}
+
+	char *pResult = &m_vecBlocks[m_iCurrentBlock][m_nBlockUsed];
+
+	V_memcpy(pResult, pszText, nLength);
+	pResult[nLength] = '\0';
+
+	m_nBlockUsed += nSize;
+	m_nUsedBytes += nSize;
+
+	return pResult;
+}
+
+void CMenu::CPageArena::Reset()
+{
+	m_iCurrentBlock = -1;
+	m_nBlockUsed = sm_nBlockSize;
+	m_nUsedBytes = 0;
+}
+
+void CMenu::CPageArena::Purge()
+{
+	for(auto *pBlock : m_vecBlocks)
+	{
+		delete[] pBlock;
+	}
+
+	m_vecBlocks.Purge();
+	Reset();
+}
+
+void CMenu::CPageArena::Swap(CPageArena &aOther)
+{
+	m_vecBlocks.Swap(aOther.m_vecBlocks);
+	std::swap(m_iCurrentBlock, aOther.m_iCurrentBlock);
+	std::swap(m_nBlockUsed, aOther.m_nBlockUsed);
+	std::swap(m_nUsedBytes, aOther.m_nUsedBytes);
+}
+
+CMenu::CPageCache::CPageCache()
+ :  m_mapPages(Key_t::Less), 
+    m_nTextBytes(0)
+{
+}
+
+CMenu::CPageCache::~CPageCache()
+{
+	Purge();
+}
+
+CMenu::IPage *CMenu::CPageCache::Find(const Key_t &aKey)
+{
+	auto &aBudget = GetPageBudget();
+
+	auto iFound = m_mapPages.Find(aKey);
+
+	if(iFound == m_mapPages.InvalidIndex())
+	{
+		aBudget.CountMiss();
+
+		return nullptr;
+	}
+
+	auto *pEntry = m_mapPages.Element(iFound);
+
+	aBudget.CountHit();
+	aBudget.Touch(pEntry);
 
-	if(pHandler)
+	if(pEntry->m_bPrerendered)
 	{
-		pHandler->OnMenuSelect(static_cast<IMenu *>(this), aSlot, iTargetItem);
+		aBudget.CountPrerenderHit();
+		pEntry->m_bPrerendered = false;
 	}
 
-	return true;
+	return pEntry->m_pPage;
 }
 
-CEntityKeyValues *CMenu::GetAllocatedBackgroundKeyValues(CPlayerSlot aSlot, CKeyValues3Context *pAllocator)
+void CMenu::CPageCache::Insert(const Key_t &aKey, IPage *pPage, bool bPrerendered)
 {
-	const IMenuProfile *pProfile = m_pProfile;
+	auto &aBudget = GetPageBudget();
 
-	Assert(pProfile);
+	const int nTextBytes = pPage->GetTextBytes();
 
-	CEntityKeyValues *pMenuKV = pProfile->GetAllocactedEntityKeyValues(pAllocator);
+	auto *pEntry = new Entry_t {aKey, pPage, this, sizeof(CPage) + sizeof(Entry_t) + nTextBytes, nullptr, nullptr, bPrerendered};
 
-	if(pMenuKV)
+	if(bPrerendered)
 	{
-		const Color *pBackgrounndColor = pProfile->GetBackgroundColor();
+		aBudget.CountPrerender();
+	}
 
-		if(pBackgrounndColor)
-		{
-			pMenuKV->SetColor("color", *pBackgrounndColor);
-		}
-		else
-		{
-			const Color *pInactiveColor = pProfile->GetInactiveColor(), 
-			            *pActiveColor = pProfile->GetActiveColor();
-	
-			if(pInactiveColor && pActiveColor)
-			{
-				pMenuKV->SetColor("color", CalculatePassiveColor(*pInactiveColor, *pActiveColor));
-			}
-		}
+	m_mapPages.Insert(aKey, pEntry);
+	m_nTextBytes += nTextBytes;
 
+	aBudget.Link(pEntry);
+	aBudget.Evict(pEntry);
+}
 
-		pMenuKV->SetString("message", GetCurrentPage(aSlot)->GetText());
+void CMenu::CPageCache::Remove(const Key_t &aKey)
+{
+	if(Drop(aKey))
+	{
+		CompactIfSparse();
 	}
-
-	return pMenuKV;
 }
 
-CEntityKeyValues *CMenu::GetAllocatedInactiveKeyValues(CPlayerSlot aSlot, CKeyValues3Context *pAllocator, bool bDrawBackground)
+bool CMenu::CPageCache::Drop(const Key_t &aKey)
 {
-	const IMenuProfile *pProfile = m_pProfile;
-
-	Assert(pProfile);
-
-	CEntityKeyValues *pMenuKV = pProfile->GetAllocactedEntityKeyValues(pAllocator);
+	auto iFound = m_mapPages.Find(aKey);
 
-	if(pMenuKV)
+	if(iFound == m_mapPages.InvalidIndex())
 	{
-		const Color *pInactiveColor = pProfile->GetInactiveColor();
+		return false;
+	}
 
-		if(pInactiveColor)
-		{
-			pMenuKV->SetColor("color", *pInactiveColor);
-		}
+	DeleteAt(iFound);
 
-		if(bDrawBackground)
-		{
-			pMenuKV->SetString("background_material_name", MENU_EMPTY_BACKGROUND_MATERIAL_NAME); // To align with the background.
-		}
+	return true;
+}
 
-		pMenuKV->SetString("message", GetCurrentPage(aSlot)->GetInactiveText());
+void CMenu::CPageCache::RemoveAll()
+{
+	FOR_EACH_MAP_FAST(m_mapPages, i)
+	{
+		DeleteAt(i);
 	}
 
-	return pMenuKV;
+	m_mapPages.RemoveAll();
+	m_aArena.Reset();
+	m_nTextBytes = 0;
 }
 
-CEntityKeyValues *CMenu::GetAllocatedActiveKeyValues(CPlayerSlot aSlot, CKeyValues3Context *pAllocator, bool bDrawBackground)
+void CMenu::CPageCache::Purge()
 {
-	const IMenuProfile *pProfile = m_pProfile;
+	RemoveAll();
 
-	Assert(pProfile);
+	m_mapPages.Purge();
+	m_aArena.Purge();
+}
 
-	CEntityKeyValues *pMenuKV = pProfile->GetAllocactedEntityKeyValues(pAllocator);
+void CMenu::CPageCache::DeleteAt(int iElement)
+{
+	auto *pEntry = m_mapPages.Element(iElement);
 
-	if(pMenuKV)
-	{
-		const Color *pActiveColor = pProfile->GetActiveColor();
+	GetPageBudget().Unlink(pEntry);
+	m_nTextBytes -= pEntry->m_pPage->GetTextBytes();
 
-		if(pActiveColor)
-		{
-			pMenuKV->SetColor("color", *pActiveColor);
-		}
+	delete pEntry->m_pPage;
+	delete pEntry;
 
-		if(bDrawBackground)
-		{
-			pMenuKV->SetString("background_material_name", MENU_EMPTY_BACKGROUND_MATERIAL_NAME); // To align with the background.
-		}
+	m_mapPages.RemoveAt(iElement);
+}
 
-		pMenuKV->SetString("message", GetCurrentPage(aSlot)->GetActiveText());
+void CMenu::CPageCache::CompactIfSparse()
+{
+	if(m_aArena.GetUsedBytes() <= 2 * m_nTextBytes + CPageArena::sm_nBlockSize)
+	{
+		return;
 	}
 
-	return pMenuKV;
+	Compact();
 }
 
-CEntityKeyValues *CMenu::GetAllocatedDisabledActiveKeyValues(CPlayerSlot aSlot, CKeyValues3Context *pAllocator, bool bDrawBackground)
+void CMenu::CPageCache::Compact()
 {
-	const IMenuProfile *pProfile = m_pProfile;
+	CPageArena aLiveArena;
 
-	Assert(pProfile);
+	FOR_EACH_MAP_FAST(m_mapPages, i)
+	{
+		m_mapPages.Element(i)->m_pPage->MoveTexts(aLiveArena);
+	}
 
-	CEntityKeyValues *pMenuKV = pProfile->GetAllocactedEntityKeyValues(pAllocator);
+	m_aArena.Swap(aLiveArena);
+}
 
-	if(pMenuKV)
-	{
-		const Color *pColor = pProfile->GetDisabledActiveColor();
+CMenu::CPageBudget &CMenu::GetPageBudget()
+{
+	static CPageBudget s_aPageBudget;
 
-		if(pColor)
-		{
-			pMenuKV->SetColor("color", *pColor);
-		}
+	return s_aPageBudget;
+}
 
-		if(bDrawBackground)
-		{
-			pMenuKV->SetString("background_material_name", MENU_EMPTY_BACKGROUND_MATERIAL_NAME); // To align with the background.
-		}
+void CMenu::CPageBudget::Link(Entry_t *pEntry)
+{
+	pEntry->m_pPrev = nullptr;
+	pEntry->m_pNext = m_pHead;
 
-		pMenuKV->SetString("message", GetCurrentPage(aSlot)->GetDisabledActiveText());
+	if(m_pHead)
+	{
+		m_pHead->m_pPrev = pEntry;
+	}
+	else
+	{
+		m_pTail = pEntry;
 	}
 
-	return pMenuKV;
+	m_pHead = pEntry;
+
+	m_aStats.m_nBytes += pEntry->m_nBytes;
+	m_aStats.m_nPages++;
 }
 
-CUtlVector<CEntityKeyValues *> CMenu::GenerateKeyValues(CPlayerSlot aSlot, CKeyValues3Context *pAllocator, bool bIncludeBackground)
+void CMenu::CPageBudget::Unlink(Entry_t *pEntry)
 {
-	Render(aSlot);
+	(pEntry->m_pPrev ? pEntry->m_pPrev->m_pNext : m_pHead) = pEntry->m_pNext;
+	(pEntry->m_pNext ? pEntry->m_pNext->m_pPrev : m_pTail) = pEntry->m_pPrev;
 
-	CUtlVector<CEntityKeyValues *> vecResult(MENU_MAX_ENTITIES);
+	pEntry->m_pPrev = pEntry->m_pNext = nullptr;
 
-	vecResult.AddToTail(bIncludeBackground ? GetAllocatedBackgroundKeyValues(aSlot, pAllocator) : nullptr);
-	vecResult.AddToTail(GetAllocatedInactiveKeyValues(aSlot, pAllocator, bIncludeBackground));
-	vecResult.AddToTail(GetAllocatedActiveKeyValues(aSlot, pAllocator, bIncludeBackground));
-	vecResult.AddToTail(GetAllocatedDisabledActiveKeyValues(aSlot, pAllocator, bIncludeBackground));
+	m_aStats.m_nBytes -= pEntry->m_nBytes;
+	m_aStats.m_nPages--;
+}
 
-	return vecResult;
+void CMenu::CPageBudget::Touch(Entry_t *pEntry)
+{
+	if(pEntry == m_pHead)
+	{
+		return;
+	}
+
+	Unlink(pEntry);
+	Link(pEntry);
 }
 
-Color CMenu::CalculatePassiveColor(const Color &rgbaActive, const Color &rgbaInactive)
+void CMenu::CPageBudget::Evict(const Entry_t *pKeep)
 {
-	struct BackgroundColor_t
+	if(!m_aStats.m_nLimit)
 	{
-		uint16 _r_sum;
-		uint16 _g_sum;
-		uint16 _b_sum;
-		uint16 _a_sum;
+		return;
+	}
 
-		BackgroundColor_t() = delete;
-		inline BackgroundColor_t(const Color &left, const Color &right)
-		 :  _r_sum(left.r() + right.r()),
-		    _g_sum(left.g() + right.g()),
-		    _b_sum(left.b() + right.b()),
-		    _a_sum(left.a() + right.a())
-		{
-		}
+	// The budget charges the texts, so their arena bytes are returned by the compaction after.
+	CUtlVector<CPageCache *> vecEvictedCaches;
 
-		inline Color GetPassiveColor()
+	while(m_aStats.m_nBytes > m_aStats.m_nLimit && m_pTail && m_pTail != pKeep)
+	{
+		auto *pCache = m_pTail->m_pCache;
+
+		const auto aKey = m_pTail->m_aKey;
+
+		pCache->Drop(aKey); // Rendered again on demand.
+		m_aStats.m_nEvictions++;
+
+		if(!vecEvictedCaches.HasElement(pCache))
 		{
-			return {_r_sum / 3, _g_sum / 3, _b_sum / 3, _a_sum / 3};
+			vecEvictedCaches.AddToTail(pCache);
 		}
-	};
+	}
 
-	return BackgroundColor_t(rgbaActive, rgbaInactive).GetPassiveColor();
+	for(auto *pCache : vecEvictedCaches)
+	{
+		pCache->Compact();
+	}
 }
 
-void CMenu::InternalSetMessage(MenuEntity_t eEntity, const char *pszText)
+CMenu::CPageBase::CPageBase(int nTextSize)
+ :  m_pszText(""), 
+    m_nTextLength(0), 
+    m_nTextBytes(0), 
+    m_nTextSize(nTextSize)
 {
-	Assert(0 <= eEntity && eEntity < Count());
+}
 
-	auto *pEntity = Element(eEntity);
+CMenu::CBufferStringText *const *CMenu::CPageBase::GetRenderLayers()
+{
+	static CBufferStringText s_aText(MENU_MAX_TEXT_LENGTH), 
+	                         s_aInactiveText(MENU_MAX_TEXT_LENGTH), 
+	                         s_aActiveText(MENU_MAX_TEXT_LENGTH), 
+	                         s_aDisabledActiveText(MENU_MAX_TEXT_LENGTH);
 
-	auto *pPointWorldTextEntity = instance_upper_cast<CPointWorldText *>(pEntity);
+	static CBufferStringText *const s_arrLayers[MENU_MAX_ENTITIES] = {&s_aText, &s_aInactiveText, &s_aActiveText, &s_aDisabledActiveText};
 
-	auto aTextAccessor = m_pSchemaHelper_PointWorldText->GetMessageTextAccessor(pPointWorldTextEntity);
+	for(auto *pLayer : s_arrLayers)
+	{
+		pLayer->Clear();
+	}
 
-	V_strncpy(aTextAccessor, pszText, aTextAccessor.GetSize());
-	aTextAccessor.MarkNetworkChanged();
+	return s_arrLayers;
 }
 
-CMenu::CPageBase::CPageBase(int nTextSize)
- :  m_sText(nTextSize)
+// Member pointers to the render variants, by CPageBase::GetRenderVariant().
+template<class PAGE, std::size_t... Indices>
+static constexpr auto MakeRenderTable(std::index_sequence<Indices...>)
 {
+	return std::array {&PAGE::template RenderAs<static_cast<IMenu::ItemControlFlags_t>(Indices & IMenu::MENU_ITEM_CONTROL_DEFAULT_FLAGS), !!(Indices & CMenu::CPageBase::sm_nRenderHandlerBit)>...};
 }
 
 // Render just base text without.
-void CMenu::CPageBase::Render(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, ItemPosition_t iStartPosition, uint8 nMaxItems)
+template<IMenu::ItemControlFlags_t CONTROLS, bool HAS_HANDLER>
+void CMenu::CPageBase::RenderAs(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, const PageBounds_t &aBounds, CPageArena &aArena)
 {
 	Clear();
 
-	const auto &aConcat = g_aMenuConcat;
+	auto *const *ppLayers = GetRenderLayers();
 
-	IMenuHandler *pHandler = pMenu->GetHandler();
+	CLayerWriter aWriter(ppLayers, 1, m_nTextSize);
+
+	[[maybe_unused]] IMenuHandler *pHandler = pMenu->GetHandler();
 
 	// Append a title.
 	{
-		auto aTitle = aData.m_title;
+		IMenu::TitleView_t aTitleView(aData.m_title);
 
-		if(pHandler)
+		if constexpr(HAS_HANDLER)
 		{
-			pHandler->OnMenuDrawTitle(static_cast<IMenu *>(pMenu), aSlot, aTitle);
+			pHandler->OnMenuDrawTitleView(static_cast<IMenu *>(pMenu), aSlot, aTitleView);
 		}
 
-		const auto &aTitleText = aTitle.m_sText;
-
-		if(!aTitleText.IsEmpty())
+		if(!aTitleView.IsEmpty())
 		{
-			const char *pszTitleText = aTitleText.Get();
-
-			CConcatLineBuffer(&aConcat, &m_sText).Append(pszTitleText);
-			CConcatLineBuffer(&aConcat, &m_sText).AppendEnds();
+			aWriter.AppendLine(CLayerWriter::MENU_LAYER_TEXT, nullptr, aTitleView.Get(), aTitleView.Length());
+			aWriter.AppendEnds();
 		}
 	}
 
 	// Append items.
 	{
-		const auto &vecItems = aData.m_vecItems;
-
-		const auto eControlFlags = aData.m_eControlFlags;
+		const auto &vecItems = aBounds.m_pItems ? *aBounds.m_pItems : aData.m_vecItems;
 
-		const bool bHasBackButton = !!(eControlFlags & MENU_ITEM_CONTROL_FLAG_BACK), 
-		           bHasNextButton = !!(eControlFlags & MENU_ITEM_CONTROL_FLAG_NEXT), 
-		           bHasExitButton = !!(eControlFlags & MENU_ITEM_CONTROL_FLAG_EXIT);
+		const ItemPosition_t iItemsBase = aBounds.m_pItems ? aBounds.m_iStartItem : MENU_FIRST_ITEM_INDEX;
 
-		const uint8 nControlsSum = bHasBackButton + bHasNextButton + bHasExitButton;
+		constexpr bool bHasBackButton = !!(CONTROLS & MENU_ITEM_CONTROL_FLAG_BACK), 
+		               bHasNextButton = !!(CONTROLS & MENU_ITEM_CONTROL_FLAG_NEXT), 
+		               bHasExitButton = !!(CONTROLS & MENU_ITEM_CONTROL_FLAG_EXIT);
 
-		int nLeftItems = vecItems.Count() - iStartPosition;
+		constexpr uint8 nControlsSum = bHasBackButton + bHasNextButton + bHasExitButton;
 
-		const bool bItemsOverflow = nLeftItems > nMaxItems, // If are elements after.
-		           bItemsHasLeft = iStartPosition >= nMaxItems; // If are elements behind.
-
-		const ItemPosition_t nItemsOnPage = bItemsOverflow ? (iStartPosition + nMaxItems) : vecItems.Count();
+		const bool bItemsOverflow = aBounds.m_bHasNext, // If are elements after.
+		           bItemsHasLeft = aBounds.m_bHasBack; // If are elements behind.
 
 		char szItemNumber[2] = ""; // Displayed item number.
 
-		for(ItemPosition_t i = iStartPosition; i < nItemsOnPage; i++)
+		int nShownItems = 0;
+
+		for(ItemPosition_t i = aBounds.m_iStartItem; i < aBounds.m_iEndItem; i++)
 		{
-			auto aItemCopy = vecItems[i];
+			const auto &aItem = vecItems[i - iItemsBase];
 
-			if(pHandler)
+			if(aItem.IsEmpty()) // Hidden, takes no number. See CPageIndex.
 			{
-				pHandler->OnMenuDisplayItem(static_cast<IMenu *>(pMenu), aSlot, i, aItemCopy);
+				continue;
 			}
 
-			const auto &sItemContent = aItemCopy.m_sContent;
+			nShownItems++;
+
+			IMenu::ItemView_t aItemView(aItem);
 
-			if(sItemContent.IsEmpty())
+			if constexpr(HAS_HANDLER)
+			{
+				pHandler->OnMenuDisplayItemView(static_cast<IMenu *>(pMenu), aSlot, i, aItemView);
+			}
+
+			if(aItemView.IsEmpty())
 			{
 				continue;
 			}
 
-			auto eItemStyle = aItemCopy.m_eStyle;
+			auto eItemStyle = aItemView.GetStyle();
 
-			const char *pszItemContent = sItemContent.Get();
+			const char *pszItemContent = aItemView.Get();
 
 			if(eItemStyle & MENU_ITEM_HASNUMBER)
 			{
-				szItemNumber[0] = '1' + (i - iStartPosition);
-				CConcatLineBuffer(&aConcat, &m_sText).Append(szItemNumber, pszItemContent);
+				szItemNumber[0] = '0' + nShownItems % 10;
+				aWriter.AppendLine(CLayerWriter::MENU_LAYER_TEXT, szItemNumber, pszItemContent);
 			}
 			else
 			{
-				CConcatLineBuffer(&aConcat, &m_sText).Append(pszItemContent);
+				aWriter.AppendLine(CLayerWriter::MENU_LAYER_TEXT, nullptr, pszItemContent);
 			}
 		}
 
@@ -573,7 +1708,7 @@ void CMenu::CPageBase::Render(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlo
 
 		if(nControlsSum && pControlItems)
 		{
-			CConcatLineBuffer(&aConcat, &m_sText).AppendEnds();
+			aWriter.AppendEnds();
 
 			auto aControlItems = *pControlItems;
 
@@ -587,29 +1722,27 @@ void CMenu::CPageBase::Render(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlo
 				                        (eControlItem == MENU_ITEM_CONTROL_NEXT_INDEX && (!bHasNextButton || !bItemsOverflow)) || 
 				                        (eControlItem == MENU_ITEM_CONTROL_EXIT_INDEX && (!bHasExitButton)); // Save the margins as in SourceMod.
 
-				auto aItemCopy = it;
+				IMenu::ItemView_t aItemView(it);
 
-				if(pHandler)
+				if constexpr(HAS_HANDLER)
 				{
-					pHandler->OnMenuDisplayItem(static_cast<IMenu *>(pMenu), aSlot, eControlItem, aItemCopy);
+					pHandler->OnMenuDisplayItemView(static_cast<IMenu *>(pMenu), aSlot, eControlItem, aItemView);
 				}
 
-				const auto &sItemContent = aItemCopy.m_sContent;
-
-				if(sItemContent.IsEmpty())
+				if(aItemView.IsEmpty())
 				{
 					continue;
 				}
 
-				auto eItemStyle = aItemCopy.m_eStyle;
+				auto eItemStyle = aItemView.GetStyle();
 
-				const char *pszItemContent = sItemContent.Get();
+				const char *pszItemContent = aItemView.Get();
 
 				if(eItemStyle & MENU_ITEM_HASNUMBER)
 				{
 					if(bSkipControlItem)
 					{
-						CConcatLineBuffer(&aConcat, &m_sText).AppendEnds();
+						aWriter.AppendEnds();
 					}
 					else
 					{
@@ -620,135 +1753,131 @@ void CMenu::CPageBase::Render(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlo
 							szItemNumber[0] -= 10;
 						}
 
-						CConcatLineBuffer(&aConcat, &m_sText).Append(szItemNumber, pszItemContent);
+						aWriter.AppendLine(CLayerWriter::MENU_LAYER_TEXT, szItemNumber, pszItemContent);
 					}
 				}
 				else
 				{
-					CConcatLineBuffer(&aConcat, &m_sText).Append(pszItemContent);
+					aWriter.AppendLine(CLayerWriter::MENU_LAYER_TEXT, nullptr, pszItemContent);
 				}
 			}
 		}
 	}
+
+	const auto *pText = ppLayers[MENU_ENTITY_BACKGROUND_INDEX];
+
+	m_nTextLength = pText->Length();
+	m_nTextBytes = m_nTextLength + 1;
+	m_pszText = aArena.Store(pText->Get(), m_nTextLength);
+}
+
+void CMenu::CPageBase::Render(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, const PageBounds_t &aBounds, CPageArena &aArena)
+{
+	static constexpr auto s_arrRenders = MakeRenderTable<CPageBase>(std::make_index_sequence<sm_nRenderVariants>());
+
+	(this->*s_arrRenders[GetRenderVariant(pMenu, aData)])(pMenu, aData, aSlot, aBounds, aArena);
+}
+
+void CMenu::CPageBase::MoveTexts(CPageArena &aArena)
+{
+	m_pszText = aArena.Store(m_pszText, m_nTextLength);
 }
 
-CMenu::CPage::CPage(int nTextSize)
+CMenu::CPage::CPage(int nTextSize, CLayerWriter::LayerMask_t nLayers)
 :  Base(nTextSize),
-  m_sInactiveText(nTextSize),
-  m_sActiveText(nTextSize),
-  m_sDisabledActiveText(nTextSize)
+  m_pszInactiveText(""),
+  m_pszActiveText(""),
+  m_pszDisabledActiveText(""),
+  m_nLayers(nLayers)
 {
 }
 
-void CMenu::CPage::Render(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, ItemPosition_t iStartPosition, uint8 nMaxItems)
+template<IMenu::ItemControlFlags_t CONTROLS, bool HAS_HANDLER>
+void CMenu::CPage::RenderAs(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, const PageBounds_t &aBounds, CPageArena &aArena)
 {
 	Clear();
 
-	const auto &aConcat = g_aMenuConcat;
+	auto *const *ppLayers = GetRenderLayers(); // By MenuEntity_t order.
+
+	CLayerWriter aWriter(ppLayers, MENU_MAX_ENTITIES, m_nTextSize, m_nLayers);
 
-	IMenuHandler *pHandler = pMenu->GetHandler();
+	[[maybe_unused]] IMenuHandler *pHandler = pMenu->GetHandler();
 
 	// Append a title.
 	{
-		auto aTitle = aData.m_title;
+		IMenu::TitleView_t aTitleView(aData.m_title);
 
-		if(pHandler)
+		if constexpr(HAS_HANDLER)
 		{
-			pHandler->OnMenuDrawTitle(static_cast<IMenu *>(pMenu), aSlot, aTitle);
+			pHandler->OnMenuDrawTitleView(static_cast<IMenu *>(pMenu), aSlot, aTitleView);
 		}
 
-		const auto &aTitleText = aTitle.m_sText;
-
-		if(!aTitleText.IsEmpty())
+		if(!aTitleView.IsEmpty())
 		{
-			const char *pszTitleText = aTitleText.Get();
-
-			CConcatLineBuffer(&aConcat, &m_sText).Append(pszTitleText);
-			CConcatLineBuffer(&aConcat, &m_sText).AppendEnds();
-			CConcatLineBuffer(&aConcat, &m_sInactiveText).Append(pszTitleText);
-			CConcatLineBuffer(&aConcat, &m_sInactiveText).AppendEnds();
-			CConcatLineBuffer(&aConcat, &m_sActiveText).AppendEndsAndStartsWith();
-			CConcatLineBuffer(&aConcat, &m_sDisabledActiveText).Append(pszTitleText);
-			CConcatLineBuffer(&aConcat, &m_sDisabledActiveText).AppendEnds();
+			// The active layer gets empty lines only.
+			aWriter.AppendLine(CLayerWriter::MENU_LAYER_ALL & ~CLayerWriter::MENU_LAYER_ACTIVE, nullptr, aTitleView.Get(), aTitleView.Length());
+			aWriter.AppendEnds();
 		}
 	}
 
 	// Append items.
 	{
-		const auto &vecItems = aData.m_vecItems;
+		const auto &vecItems = aBounds.m_pItems ? *aBounds.m_pItems : aData.m_vecItems;
 
-		const auto eControlFlags = aData.m_eControlFlags;
+		const ItemPosition_t iItemsBase = aBounds.m_pItems ? aBounds.m_iStartItem : MENU_FIRST_ITEM_INDEX;
 
-		const bool bHasBackButton = !!(eControlFlags & MENU_ITEM_CONTROL_FLAG_BACK),
-							bHasNextButton = !!(eControlFlags & MENU_ITEM_CONTROL_FLAG_NEXT),
-							bHasExitButton = !!(eControlFlags & MENU_ITEM_CONTROL_FLAG_EXIT);
+		constexpr bool bHasBackButton = !!(CONTROLS & MENU_ITEM_CONTROL_FLAG_BACK),
+		               bHasNextButton = !!(CONTROLS & MENU_ITEM_CONTROL_FLAG_NEXT),
+		               bHasExitButton = !!(CONTROLS & MENU_ITEM_CONTROL_FLAG_EXIT);
 
-		const uint8 nControlsSum = bHasBackButton + bHasNextButton + bHasExitButton;
+		constexpr uint8 nControlsSum = bHasBackButton + bHasNextButton + bHasExitButton;
 
-		int nLeftItems = vecItems.Count() - iStartPosition;
-
-		const bool bItemsOverflow = nLeftItems > nMaxItems,
-							bItemsHasLeft = iStartPosition >= nMaxItems;
-
-		const ItemPosition_t nItemsOnPage = bItemsOverflow ? (iStartPosition + nMaxItems) : vecItems.Count();
+		const bool bItemsOverflow = aBounds.m_bHasNext,
+		           bItemsHasLeft = aBounds.m_bHasBack;
 
 		char szItemNumber[2] = "";
 
-		for(ItemPosition_t i = iStartPosition; i < nItemsOnPage; i++)
+		int nShownItems = 0;
+
+		for(ItemPosition_t i = aBounds.m_iStartItem; i < aBounds.m_iEndItem; i++)
 		{
-			auto aItemCopy = vecItems[i];
+			const auto &aItem = vecItems[i - iItemsBase];
 
-			if(pHandler)
+			if(aItem.IsEmpty())
 			{
-				pHandler->OnMenuDisplayItem(static_cast<IMenu *>(pMenu), aSlot, i, aItemCopy);
+				continue;
 			}
 
-			const auto &sItemContent = aItemCopy.m_sContent;
+			nShownItems++;
+
+			IMenu::ItemView_t aItemView(aItem);
+
+			if constexpr(HAS_HANDLER)
+			{
+				pHandler->OnMenuDisplayItemView(static_cast<IMenu *>(pMenu), aSlot, i, aItemView);
+			}
 
-			if(sItemContent.IsEmpty())
+			if(aItemView.IsEmpty())
 			{
 				continue;
 			}
 
-			auto eItemStyle = aItemCopy.m_eStyle;
+			auto eItemStyle = aItemView.GetStyle();
 
-			const char *pszItemContent = sItemContent.Get();
+			const char *pszItemContent = aItemView.Get();
+
+			const char *pszItemNumber = nullptr;
 
 			if(eItemStyle & MENU_ITEM_HASNUMBER)
 			{
-				szItemNumber[0] = '1' + (i - iStartPosition);
-				CConcatLineBuffer(&aConcat, &m_sText).Append(szItemNumber, pszItemContent);
-
-				if(eItemStyle & MENU_ITEM_ACTIVE)
-				{
-					CConcatLineBuffer(&aConcat, &m_sInactiveText).AppendEnds();
-					CConcatLineBuffer(&aConcat, &m_sActiveText).Append(szItemNumber, pszItemContent);
-					CConcatLineBuffer(&aConcat, &m_sDisabledActiveText).AppendEnds();
-				}
-				else
-				{
-					CConcatLineBuffer(&aConcat, &m_sInactiveText).Append(szItemNumber, pszItemContent);
-					CConcatLineBuffer(&aConcat, &m_sActiveText).AppendEnds();
-					CConcatLineBuffer(&aConcat, &m_sDisabledActiveText).Append(szItemNumber, pszItemContent);
-				}
+				szItemNumber[0] = '0' + nShownItems % 10;
+				pszItemNumber = szItemNumber;
 			}
-			else
-			{
-				CConcatLineBuffer(&aConcat, &m_sText).Append(pszItemContent);
 
-				if(eItemStyle & MENU_ITEM_ACTIVE)
-				{
-					CConcatLineBuffer(&aConcat, &m_sInactiveText).AppendEnds();
-					CConcatLineBuffer(&aConcat, &m_sActiveText).Append(pszItemContent);
-					CConcatLineBuffer(&aConcat, &m_sDisabledActiveText).AppendEnds();
-				}
-				else
-				{
-					CConcatLineBuffer(&aConcat, &m_sInactiveText).Append(pszItemContent);
-					CConcatLineBuffer(&aConcat, &m_sActiveText).AppendEnds();
-					CConcatLineBuffer(&aConcat, &m_sDisabledActiveText).Append(pszItemContent);
-				}
-			}
+			// An active item is drawn by the active layer, an inactive one by the inactive and the disabled active layers.
+			CLayerWriter::LayerMask_t nLineLayers = CLayerWriter::MENU_LAYER_TEXT | ((eItemStyle & MENU_ITEM_ACTIVE) ? CLayerWriter::MENU_LAYER_ACTIVE : (CLayerWriter::MENU_LAYER_INACTIVE | CLayerWriter::MENU_LAYER_DISABLED_ACTIVE));
+
+			aWriter.AppendLine(nLineLayers, pszItemNumber, pszItemContent);
 		}
 
 		// Append control items.
@@ -756,10 +1885,7 @@ void CMenu::CPage::Render(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, I
 
 		if(nControlsSum && pControlItems)
 		{
-			CConcatLineBuffer(&aConcat, &m_sText).AppendEnds();
-			CConcatLineBuffer(&aConcat, &m_sInactiveText).AppendEnds();
-			CConcatLineBuffer(&aConcat, &m_sActiveText).AppendEnds();
-			CConcatLineBuffer(&aConcat, &m_sDisabledActiveText).AppendEnds();
+			aWriter.AppendEnds();
 
 			auto aControlItems = *pControlItems;
 
@@ -770,34 +1896,30 @@ void CMenu::CPage::Render(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, I
 				ItemControls_t eControlItem = static_cast<ItemControls_t>(-static_cast<ItemPosition_t>(i + 1));
 
 				bool bSkipControlItem = (eControlItem == MENU_ITEM_CONTROL_BACK_INDEX && (!bHasBackButton || !bItemsHasLeft)) ||
-																(eControlItem == MENU_ITEM_CONTROL_NEXT_INDEX && (!bHasNextButton || !bItemsOverflow)) ||
-																(eControlItem == MENU_ITEM_CONTROL_EXIT_INDEX && (!bHasExitButton));
+				                        (eControlItem == MENU_ITEM_CONTROL_NEXT_INDEX && (!bHasNextButton || !bItemsOverflow)) ||
+				                        (eControlItem == MENU_ITEM_CONTROL_EXIT_INDEX && (!bHasExitButton));
 
-				auto aItemCopy = it;
+				IMenu::ItemView_t aItemView(it);
 
-				if(pHandler)
+				if constexpr(HAS_HANDLER)
 				{
-					pHandler->OnMenuDisplayItem(static_cast<IMenu *>(pMenu), aSlot, eControlItem, aItemCopy);
+					pHandler->OnMenuDisplayItemView(static_cast<IMenu *>(pMenu), aSlot, eControlItem, aItemView);
 				}
 
-				const auto &sItemContent = aItemCopy.m_sContent;
-
-				if(sItemContent.IsEmpty())
+				if(aItemView.IsEmpty())
 				{
 					continue;
 				}
 
-				auto eItemStyle = aItemCopy.m_eStyle;
+				auto eItemStyle = aItemView.GetStyle();
+
+				const char *pszItemContent = aItemView.Get();
 
-				const char *pszItemContent = sItemContent.Get();
+				CLayerWriter::LayerMask_t nLineLayers;
 
 				if(eItemStyle & MENU_ITEM_HASNUMBER)
 				{
-					if(bSkipControlItem)
-					{
-						CConcatLineBuffer(&aConcat, &m_sText).AppendEnds();
-					}
-					else
+					if(!bSkipControlItem)
 					{
 						szItemNumber[0] = '8' + i;
 
@@ -805,75 +1927,83 @@ void CMenu::CPage::Render(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, I
 						{
 							szItemNumber[0] -= 10;
 						}
-
-						CConcatLineBuffer(&aConcat, &m_sText).Append(szItemNumber, pszItemContent);
 					}
 
 					if(eItemStyle & MENU_ITEM_ACTIVE)
 					{
-						CConcatLineBuffer(&aConcat, &m_sInactiveText).AppendEnds();
-
-						if(bSkipControlItem)
-						{
-							CConcatLineBuffer(&aConcat, &m_sActiveText).AppendEnds();
-						}
-						else
-						{
-							CConcatLineBuffer(&aConcat, &m_sActiveText).Append(szItemNumber, pszItemContent);
-						}
-
-						CConcatLineBuffer(&aConcat, &m_sDisabledActiveText).AppendEnds();
+						nLineLayers = bSkipControlItem ? 0 : (CLayerWriter::MENU_LAYER_TEXT | CLayerWriter::MENU_LAYER_ACTIVE);
 					}
 					else
 					{
-						if(bSkipControlItem)
-						{
-							CConcatLineBuffer(&aConcat, &m_sInactiveText).Append(szItemNumber, pszItemContent);
-						}
-						else
-						{
-							CConcatLineBuffer(&aConcat, &m_sInactiveText).AppendEnds();
-						}
-
-						CConcatLineBuffer(&aConcat, &m_sActiveText).AppendEnds();
-						CConcatLineBuffer(&aConcat, &m_sDisabledActiveText).Append(szItemNumber, pszItemContent);
+						// A skipped one keeps its margin in the inactive layer with the last number.
+						nLineLayers = (bSkipControlItem ? CLayerWriter::MENU_LAYER_INACTIVE : CLayerWriter::MENU_LAYER_TEXT) | CLayerWriter::MENU_LAYER_DISABLED_ACTIVE;
 					}
+
+					aWriter.AppendLine(nLineLayers, szItemNumber, pszItemContent);
 				}
 				else
 				{
-					CConcatLineBuffer(&aConcat, &m_sText).Append(pszItemContent);
-
 					if(eItemStyle & MENU_ITEM_ACTIVE)
 					{
-						CConcatLineBuffer(&aConcat, &m_sInactiveText).AppendEnds();
-
-						if(bSkipControlItem)
-						{
-							CConcatLineBuffer(&aConcat, &m_sActiveText).AppendEnds();
-						}
-						else
-						{
-							CConcatLineBuffer(&aConcat, &m_sActiveText).Append(pszItemContent);
-						}
-
-						CConcatLineBuffer(&aConcat, &m_sDisabledActiveText).AppendEnds();
+						nLineLayers = CLayerWriter::MENU_LAYER_TEXT | (bSkipControlItem ? 0 : CLayerWriter::MENU_LAYER_ACTIVE);
 					}
 					else
 					{
-						if(bSkipControlItem)
-						{
-							CConcatLineBuffer(&aConcat, &m_sInactiveText).AppendEnds();
-						}
-						else
-						{
-							CConcatLineBuffer(&aConcat, &m_sInactiveText).Append(pszItemContent);
-						}
-
-						CConcatLineBuffer(&aConcat, &m_sActiveText).AppendEnds();
-						CConcatLineBuffer(&aConcat, &m_sDisabledActiveText).Append(pszItemContent);
+						nLineLayers = CLayerWriter::MENU_LAYER_TEXT | (bSkipControlItem ? 0 : CLayerWriter::MENU_LAYER_INACTIVE) | CLayerWriter::MENU_LAYER_DISABLED_ACTIVE;
 					}
+
+					aWriter.AppendLine(nLineLayers, nullptr, pszItemContent);
 				}
 			}
 		}
 	}
+
+	auto Store = [&](MenuEntity_t eEntity) -> const char *
+	{
+		if(!(m_nLayers & (1 << eEntity)))
+		{
+			return ""; // Not spawned.
+		}
+
+		const auto *pLayer = ppLayers[eEntity];
+
+		const int nLength = pLayer->Length();
+
+		m_nTextBytes += nLength + 1;
+
+		return aArena.Store(pLayer->Get(), nLength);
+	};
+
+	m_nTextLength = ppLayers[MENU_ENTITY_BACKGROUND_INDEX]->Length();
+	m_pszText = Store(MENU_ENTITY_BACKGROUND_INDEX);
+	m_pszInactiveText = Store(MENU_ENTITY_INACTIVE_INDEX);
+	m_pszActiveText = Store(MENU_ENTITY_ACTIVE_INDEX);
+	m_pszDisabledActiveText = Store(MENU_ENTITY_DISABLED_ACTIVE_INDEX);
+}
+
+void CMenu::CPage::Render(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, const PageBounds_t &aBounds, CPageArena &aArena)
+{
+	static constexpr auto s_arrRenders = MakeRenderTable<CPage>(std::make_index_sequence<sm_nRenderVariants>());
+
+	(this->*s_arrRenders[GetRenderVariant(pMenu, aData)])(pMenu, aData, aSlot, aBounds, aArena);
+}
+
+void CMenu::CPage::MoveTexts(CPageArena &aArena)
+{
+	Base::MoveTexts(aArena);
+
+	// As RenderAs() stores them, so the arena takes m_nTextBytes.
+	auto Move = [&](MenuEntity_t eEntity, const char *pszText) -> const char *
+	{
+		if(!(m_nLayers & (1 << eEntity)))
+		{
+			return ""; // Not spawned.
+		}
+
+		return aArena.Store(pszText, V_strlen(pszText));
+	};
+
+	m_pszInactiveText = Move(MENU_ENTITY_INACTIVE_INDEX, m_pszInactiveText);
+	m_pszActiveText = Move(MENU_ENTITY_ACTIVE_INDEX, m_pszActiveText);
+	m_pszDisabledActiveText = Move(MENU_ENTITY_DISABLED_ACTIVE_INDEX, m_pszDisabledActiveText);
 }
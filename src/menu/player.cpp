@@ -83,7 +83,7 @@ void MenuSystem_Plugin::CPlayer::OnLanguageChanged(CPlayerSlot aSlot, CLanguage
 	}
 }
 
-bool MenuSystem_Plugin::CPlayer::OnMenuDisplayItem(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iItem, IMenu::Item_t &aData)
+bool MenuSystem_Plugin::CPlayer::OnMenuDisplayItem(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iItem, IMenu::ItemView_t &aView)
 {
 	const TranslatedPhrase_t *pPhrase = nullptr;
 
@@ -114,7 +114,7 @@ bool MenuSystem_Plugin::CPlayer::OnMenuDisplayItem(IMenu *pMenu, CPlayerSlot aSl
 			return false;
 		}
 
-		aData.m_sContent = *pPhrase->m_pContent;
+		aView.SetRef(*pPhrase->m_pContent); // Phrases outlive the render.
 	}
 
 	return bHasPhrase;
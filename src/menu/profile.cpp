@@ -67,6 +67,16 @@ Menu::CProfile::CProfile::~CProfile()
 	{
 		delete m_pData;
 	}
+
+	if(m_pFlattenedData)
+	{
+		delete m_pFlattenedData;
+	}
+
+	if(m_pFlattenedDataWithoutBackground)
+	{
+		delete m_pFlattenedDataWithoutBackground;
+	}
 }
 
 bool Menu::CProfile::Load(CProfileSystem *pSystem, KeyValues3 *pData, ProfileLoadFlags_t eFlags, CUtlVector<CUtlString> &vecMessages)
@@ -91,6 +101,18 @@ bool Menu::CProfile::Load(CProfileSystem *pSystem, KeyValues3 *pData, ProfileLoa
 	m_pActiveColor = (pMember = pData->FindMember("active_color")) ? new Color(pMember->GetColor()) : nullptr;
 	m_pDisabledActiveColor = (pMember = pData->FindMember("disabled_active_color")) ? new Color(pMember->GetColor()) : nullptr;
 	m_flBackgroundAwayUnits = pData->GetMemberFloat("background_away_units");
+	m_nLayers = pData->GetMemberInt("layers");
+
+	if(m_nLayers && (m_nLayers < MENU_PROFILE_MIN_LAYERS || MENU_PROFILE_MAX_LAYERS < m_nLayers))
+	{
+		CUtlString sLayersMessage = "Layers \"";
+
+		sLayersMessage += m_nLayers;
+		sLayersMessage += "\" out of range, inherited ones are used";
+		vecMessages.AddToTail(sLayersMessage);
+		m_nLayers = 0;
+	}
+
 	m_vecResources.AddToTail(pData->GetMemberString("background_material_name"));
 
 	if(!(eFlags & PROFILE_LOAD_FLAG_DONT_REMOVE_STATIC_MEMBERS))
@@ -307,6 +329,7 @@ void Menu::CProfile::RemoveStaticMembers(KeyValues3 *pData)
 	pData->RemoveMember("active_color");
 	pData->RemoveMember("disabled_active_color");
 	pData->RemoveMember("background_away_units");
+	pData->RemoveMember("layers");
 }
 
 void Menu::CProfile::RemoveStaticMetadataMembers(KeyValues3 *pData)
@@ -514,6 +537,29 @@ float Menu::CProfile::GetBackgroundAwayUnits() const
 	return flResult;
 }
 
+int Menu::CProfile::GetLayers() const
+{
+	return m_nFlattenedLayers ? m_nFlattenedLayers : MergeLayers(); // Asked by each render.
+}
+
+int Menu::CProfile::MergeLayers() const
+{
+	int nResult = m_nLayers;
+
+	if(!nResult)
+	{
+		for(const auto &pInherited : m_aMetadata.GetBaseline())
+		{
+			if(nResult = pInherited->m_nLayers)
+			{
+				break;
+			}
+		}
+	}
+
+	return nResult ? nResult : MENU_PROFILE_MAX_LAYERS;
+}
+
 
 CUtlVector<const char *> Menu::CProfile::GetResources() const
 {
@@ -533,7 +579,43 @@ CUtlVector<const char *> Menu::CProfile::GetResources() const
 	return vecResult;
 }
 
+void Menu::CProfile::FlattenEntityKeyValues(CProfileSystem *pSystem)
+{
+	auto *pAllocator = pSystem->GetEntityKeyValuesAllocator();
+
+	if(m_pFlattenedData)
+	{
+		delete m_pFlattenedData;
+	}
+
+	if(m_pFlattenedDataWithoutBackground)
+	{
+		delete m_pFlattenedDataWithoutBackground;
+	}
+
+	m_pFlattenedData = MergeAllocatedEntityKeyValues(pAllocator, true);
+	m_pFlattenedDataWithoutBackground = MergeAllocatedEntityKeyValues(pAllocator, false);
+	m_nFlattenedLayers = MergeLayers();
+}
+
 CEntityKeyValues *Menu::CProfile::GetAllocactedEntityKeyValues(CKeyValues3Context *pAllocator, bool bIncludeBackground) const
+{
+	const CEntityKeyValues *pFlattenedData = bIncludeBackground ? m_pFlattenedData : m_pFlattenedDataWithoutBackground;
+
+	if(!pFlattenedData) // Not loaded yet.
+	{
+		return MergeAllocatedEntityKeyValues(pAllocator, bIncludeBackground);
+	}
+
+	CEntityKeyValues *pResult = new CEntityKeyValues(pAllocator, pAllocator ? EKV_ALLOCATOR_EXTERNAL : EKV_ALLOCATOR_NORMAL);
+
+	Assert(pResult);
+	pResult->CopyFrom(pFlattenedData);
+
+	return pResult;
+}
+
+CEntityKeyValues *Menu::CProfile::MergeAllocatedEntityKeyValues(CKeyValues3Context *pAllocator, bool bIncludeBackground) const
 {
 	CEntityKeyValues *pResult = new CEntityKeyValues(pAllocator, pAllocator ? EKV_ALLOCATOR_EXTERNAL : EKV_ALLOCATOR_NORMAL);
 
@@ -208,6 +208,12 @@ bool Menu::CProfileSystem::Load2(KeyValues3 *pData, CUtlVector<CUtlString> &vecM
 	}
 	while(i < nMemberCount);
 
+	// The bases are loaded now.
+	FOR_EACH_MAP_FAST(m_map, j)
+	{
+		m_map.Element(j)->FlattenEntityKeyValues(this);
+	}
+
 	return true;
 }
 
@@ -26,42 +26,184 @@
 #include <utility>
 #include <map>
 
+// Items of a menu by the callbacks.
+class CItemSourceWrapper : public IMenu::IItemSource
+{
+public:
+	CItemSourceWrapper(IMenuItemSourceCount_t pfnCount, IMenuItemSourceContent_t pfnContent, IMenuItemHandler_t pfnItemHandler, void *pData)
+	 :  m_pfnCount(pfnCount), 
+	    m_pfnContent(pfnContent), 
+	    m_pfnItemHandler(pfnItemHandler), 
+	    m_pData(pData)
+	{
+	}
+
+	IMenuItemHandler_t GetItemHandler() const
+	{
+		return m_pfnItemHandler;
+	}
+
+public: // IMenu::IItemSource
+	IMenu::ItemPosition_t GetItemCount(IMenu *pMenu) override
+	{
+		return m_pfnCount(MenuSystem()->GetInstanceHandle(pMenu), m_pData);
+	}
+
+	void GetItems(IMenu *pMenu, IMenu::ItemPosition_t iStartItem, IMenu::ItemPosition_t nCount, IMenu::Items_t &vecItems) override;
+
+private:
+	IMenuItemSourceCount_t m_pfnCount;
+	IMenuItemSourceContent_t m_pfnContent;
+	IMenuItemHandler_t m_pfnItemHandler;
+	void *m_pData;
+};
+
 class CMenuWrapper : public IMenuHandler, public IMenu::IItemHandler
 {
 public:
 	using Key_t = std::pair<IMenuItemPosition_t, IMenu_t *>;
+	using TemplateKey_t = std::pair<IMenuItemPosition_t, IMenuTemplate_t *>;
 	using Value_t = IMenuItemHandler_t;
 
 public: // IMenuHandler
+	void OnMenuStart(IMenu *pMenu) override
+	{
+		// Also the instances the system creates from a template, see IMenuSystem::DisplayInstanceToPlayers.
+		IMenuTemplate_t *pTemplate = MenuSystem()->GetInstanceTemplate(pMenu);
+
+		if(pTemplate)
+		{
+			AddTemplateInstance(pMenu, pTemplate);
+		}
+	}
+
 	void OnMenuDestroy(IMenu *pMenu) override
 	{
 		RemoveHandlers(pMenu);
+		RemoveTemplateInstance(pMenu);
+		m_mapItemSources.erase(pMenu);
+	}
+
+	OverrideFlags_t GetMenuOverrides() const override
+	{
+		return MENU_HANDLER_OVERRIDES_NONE; // The title and items are not customized, so keep them uncopied.
 	}
 
 public: // IMenu::IItemHandler
 	void OnMenuSelectItem(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iItem, IMenu::ItemPositionOnPage_t iItemOnPage, void *pData) override
 	{
-		auto itFound = m_mapHandlers.find({iItem, pMenu});
+		auto *pHandler = FindHandler(pMenu, iItem);
 
-		if(itFound == m_mapHandlers.cend())
+		if(!pHandler)
 		{
 			return;
 		}
 
-		auto *pHandler = itFound->second;
+		pHandler(MenuSystem()->GetInstanceHandle(pMenu), aSlot, iItem, iItemOnPage, pData);
+	}
 
-		if(!pHandler)
+public:
+	void AddHandler(const Key_t &aKey, const Value_t &aValue)
+	{
+		m_mapHandlers.emplace(aKey, aValue);
+	}
+
+	void SetTemplateHandler(const TemplateKey_t &aKey, const Value_t &aValue)
+	{
+		m_mapTemplateHandlers.insert_or_assign(aKey, aValue);
+	}
+
+	// Instances keep the template alive, so its handlers go with the last of them.
+	void AddTemplateInstance(IMenu_t *pMenu, IMenuTemplate_t *pTemplate)
+	{
+		if(m_mapInstanceTemplates.emplace(pMenu, pTemplate).second)
+		{
+			m_mapTemplates[pTemplate].m_nInstances++;
+		}
+	}
+
+	void RemoveTemplateInstance(const IMenu_t *pMenu)
+	{
+		auto itFound = m_mapInstanceTemplates.find(pMenu);
+
+		if(itFound == m_mapInstanceTemplates.cend())
 		{
 			return;
 		}
 
-		pHandler(pMenu, aSlot, iItem, iItemOnPage, pData);
+		IMenuTemplate_t *pTemplate = itFound->second;
+
+		m_mapInstanceTemplates.erase(itFound);
+
+		auto itTemplate = m_mapTemplates.find(pTemplate);
+
+		Assert(itTemplate != m_mapTemplates.cend());
+
+		auto &aTemplate = itTemplate->second;
+
+		if(!--aTemplate.m_nInstances && aTemplate.m_bReleased)
+		{
+			RemoveTemplateHandlers(pTemplate);
+			m_mapTemplates.erase(itTemplate);
+		}
 	}
 
-public:
-	void AddHandler(const Key_t &aKey, const Value_t &aValue)
+	void ReleaseTemplate(IMenuTemplate_t *pTemplate)
 	{
-		m_mapHandlers.emplace(aKey, aValue);
+		auto itFound = m_mapTemplates.find(pTemplate);
+
+		if(itFound != m_mapTemplates.cend() && itFound->second.m_nInstances)
+		{
+			itFound->second.m_bReleased = true;
+
+			return;
+		}
+
+		RemoveTemplateHandlers(pTemplate);
+
+		if(itFound != m_mapTemplates.cend())
+		{
+			m_mapTemplates.erase(itFound);
+		}
+	}
+
+	// Replaces the previous one, which is no longer set.
+	CItemSourceWrapper *SetItemSource(IMenu_t *pMenu, const CItemSourceWrapper &aSource)
+	{
+		return &m_mapItemSources.insert_or_assign(pMenu, aSource).first->second;
+	}
+
+	void RemoveItemSource(IMenu_t *pMenu)
+	{
+		m_mapItemSources.erase(pMenu);
+	}
+
+	Value_t FindHandler(IMenu_t *pMenu, IMenuItemPosition_t iItem) const
+	{
+		auto itSourceFound = m_mapItemSources.find(pMenu);
+
+		if(itSourceFound != m_mapItemSources.cend() && pMenu->GetItemSource() == &itSourceFound->second)
+		{
+			return itSourceFound->second.GetItemHandler();
+		}
+
+		auto itFound = m_mapHandlers.find({iItem, pMenu});
+
+		if(itFound != m_mapHandlers.cend())
+		{
+			return itFound->second;
+		}
+
+		IMenuTemplate_t *pTemplate = MenuSystem()->GetInstanceTemplate(pMenu);
+
+		if(!pTemplate)
+		{
+			return nullptr;
+		}
+
+		auto itTemplateFound = m_mapTemplateHandlers.find({iItem, pTemplate});
+
+		return itTemplateFound == m_mapTemplateHandlers.cend() ? nullptr : itTemplateFound->second;
 	}
 
 	void RemoveHandlers(const IMenu_t *pMenu)
@@ -81,10 +223,53 @@ public:
 		}
 	}
 
+	void RemoveTemplateHandlers(const IMenuTemplate_t *pTemplate)
+	{
+		auto &mapHandlers = m_mapTemplateHandlers;
+
+		for(auto it = mapHandlers.begin(); it != mapHandlers.end();)
+		{
+			if(it->first.second == pTemplate)
+			{
+				it = mapHandlers.erase(it);
+			}
+			else
+			{
+				it++;
+			}
+		}
+	}
+
 private:
+	struct TemplateState_t
+	{
+		int m_nInstances = 0;
+		bool m_bReleased = false;
+	};
+
 	std::map<Key_t, Value_t> m_mapHandlers;
+	std::map<TemplateKey_t, Value_t> m_mapTemplateHandlers;
+	std::map<const IMenuTemplate_t *, TemplateState_t> m_mapTemplates;
+	std::map<const IMenu_t *, IMenuTemplate_t *> m_mapInstanceTemplates;
+	std::map<const IMenu_t *, CItemSourceWrapper> m_mapItemSources;
 } g_aMenuWrapper;
 
+void CItemSourceWrapper::GetItems(IMenu *pMenu, IMenu::ItemPosition_t iStartItem, IMenu::ItemPosition_t nCount, IMenu::Items_t &vecItems)
+{
+	IMenuHandle_t hMenu = MenuSystem()->GetInstanceHandle(pMenu);
+
+	vecItems.EnsureCapacity(vecItems.Count() + nCount);
+
+	for(IMenu::ItemPosition_t i = iStartItem; i < iStartItem + nCount; i++)
+	{
+		IMenuItemStyleFlags_t eStyles = IMenu::MENU_ITEM_DEFAULT;
+
+		const char *pszContent = m_pfnContent(hMenu, i, &eStyles, m_pData);
+
+		vecItems.AddToTail({eStyles, pszContent ? pszContent : "", static_cast<IMenu::IItemHandler *>(&g_aMenuWrapper), m_pData});
+	}
+}
+
 // The menu system functions.
 
 MENU_DLL_EXPORT IMenuSystem_t *MenuSystem()
@@ -92,24 +277,103 @@ MENU_DLL_EXPORT IMenuSystem_t *MenuSystem()
 	return static_cast<IMenuSystem *>(g_pMenuPlugin);
 }
 
+static inline IMenu_t *FindMenu(IMenuHandle_t hMenu)
+{
+	return MenuSystem()->FindInstanceByHandle(hMenu);
+}
+
 MENU_DLL_EXPORT IMenuProfileSystem_t *MenuSystem_GetProfiles(IMenuSystem_t *pSystem)
 {
 	return pSystem->GetProfiles();
 }
 
-MENU_DLL_EXPORT IMenu_t *MenuSystem_CreateInstance(IMenuSystem_t *pSystem, IMenuProfile_t *pProfile)
+MENU_DLL_EXPORT IMenuHandle_t MenuSystem_CreateInstance(IMenuSystem_t *pSystem, IMenuProfile_t *pProfile)
 {
-	return pSystem->CreateInstance(pProfile, static_cast<IMenuHandler *>(&g_aMenuWrapper));
+	return pSystem->GetInstanceHandle(pSystem->CreateInstance(pProfile, static_cast<IMenuHandler *>(&g_aMenuWrapper)));
 }
 
-MENU_DLL_EXPORT bool MenuSystem_DisplayInstanceToPlayer(IMenuSystem_t *pSystem, IMenu_t *pMenuInstance, CPlayerSlot aSlot, IMenuItemPosition_t iStartItem, int nManyTimes)
+MENU_DLL_EXPORT bool MenuSystem_DisplayInstanceToPlayer(IMenuSystem_t *pSystem, IMenuHandle_t hMenu, CPlayerSlot aSlot, IMenuItemPosition_t iStartItem, int nManyTimes)
 {
-	return pSystem->DisplayInstanceToPlayer(pMenuInstance, aSlot, iStartItem, nManyTimes);
+	IMenu_t *pMenu = pSystem->FindInstanceByHandle(hMenu);
+
+	return pMenu && pSystem->DisplayInstanceToPlayer(pMenu, aSlot, iStartItem, nManyTimes);
 }
 
-MENU_DLL_EXPORT bool MenuSystem_CloseInstance(IMenuSystem_t *pSystem, IMenu_t *pMenuInstance)
+MENU_DLL_EXPORT int MenuSystem_DisplayInstanceToPlayers(IMenuSystem_t *pSystem, IMenuHandle_t hMenu, unsigned long long nPlayerMask, IMenuHandle_t *pHandles, IMenuItemPosition_t iStartItem, int nManyTimes)
 {
-	return pSystem->CloseInstance(pMenuInstance);
+	IMenu_t *pMenu = pSystem->FindInstanceByHandle(hMenu);
+
+	if(!pMenu)
+	{
+		return 0;
+	}
+
+	static_assert(ABSOLUTE_PLAYER_LIMIT <= sizeof(nPlayerMask) * 8);
+
+	CPlayerBitVec bvPlayers;
+
+	for(int iClient = 0; iClient < ABSOLUTE_PLAYER_LIMIT; iClient++)
+	{
+		if(nPlayerMask & (1ULL << iClient))
+		{
+			bvPlayers.Set(iClient);
+		}
+	}
+
+	return pSystem->DisplayInstanceToPlayers(pMenu, bvPlayers, pHandles, iStartItem, nManyTimes);
+}
+
+MENU_DLL_EXPORT bool MenuSystem_CloseInstance(IMenuSystem_t *pSystem, IMenuHandle_t hMenu)
+{
+	IMenu_t *pMenu = pSystem->FindInstanceByHandle(hMenu);
+
+	return pMenu && pSystem->CloseInstance(pMenu);
+}
+
+MENU_DLL_EXPORT bool MenuSystem_CloseInstanceNow(IMenuSystem_t *pSystem, IMenuHandle_t hMenu)
+{
+	IMenu_t *pMenu = pSystem->FindInstanceByHandle(hMenu);
+
+	return pMenu && pSystem->CloseInstanceNow(pMenu);
+}
+
+MENU_DLL_EXPORT bool MenuSystem_IsValidInstance(IMenuSystem_t *pSystem, IMenuHandle_t hMenu)
+{
+	return pSystem->FindInstanceByHandle(hMenu) != nullptr;
+}
+
+MENU_DLL_EXPORT IMenuTemplate_t *MenuSystem_CreateTemplate(IMenuSystem_t *pSystem)
+{
+	return pSystem->CreateTemplate();
+}
+
+MENU_DLL_EXPORT void MenuSystem_ReleaseTemplate(IMenuSystem_t *pSystem, IMenuTemplate_t *pTemplate)
+{
+	if(pTemplate)
+	{
+		g_aMenuWrapper.ReleaseTemplate(pTemplate);
+		pSystem->ReleaseTemplate(pTemplate);
+	}
+}
+
+MENU_DLL_EXPORT IMenuHandle_t MenuSystem_CreateInstanceFromTemplate(IMenuSystem_t *pSystem, IMenuTemplate_t *pTemplate, IMenuProfile_t *pProfile)
+{
+	if(!pTemplate)
+	{
+		return MENU_INVALID_HANDLE;
+	}
+
+	// The wrapper does not customize the items, so pages are shared.
+	IMenu_t *pMenu = pSystem->CreateInstanceFromTemplate(pTemplate, pProfile, static_cast<IMenuHandler *>(&g_aMenuWrapper));
+
+	if(!pMenu)
+	{
+		return MENU_INVALID_HANDLE;
+	}
+
+	g_aMenuWrapper.AddTemplateInstance(pMenu, pTemplate);
+
+	return pSystem->GetInstanceHandle(pMenu);
 }
 
 // The menu profile system functions.
@@ -119,81 +383,212 @@ MENU_DLL_EXPORT IMenuProfile_t *MenuProfileSystem_Get(IMenuProfileSystem_t *pPro
 	return pProfileSystem->Get(pszName);
 }
 
+// The menu template functions.
+
+MENU_DLL_EXPORT bool MenuTemplate_SetTitle(IMenuTemplate_t *pTemplate, const char *pszNewText)
+{
+	return pTemplate && pTemplate->SetTitle(pszNewText);
+}
+
+MENU_DLL_EXPORT IMenuItemPosition_t MenuTemplate_AddItem(IMenuTemplate_t *pTemplate, IMenuItemStyleFlags_t eFlags, const char *pszContent, IMenuItemHandler_t pfnItemHandler, void *pData)
+{
+	if(!pTemplate || pTemplate->IsSealed())
+	{
+		return -1;
+	}
+
+	g_aMenuWrapper.SetTemplateHandler(std::make_pair(pTemplate->GetItems().Count(), pTemplate), pfnItemHandler);
+
+	return pTemplate->AddItem({eFlags, pszContent, static_cast<IMenu::IItemHandler *>(&g_aMenuWrapper), pData});
+}
+
+MENU_DLL_EXPORT bool MenuTemplate_SetItemControls(IMenuTemplate_t *pTemplate, IMenuItemControlFlags_t eNewControls)
+{
+	return pTemplate && pTemplate->SetItemControls(eNewControls);
+}
+
 // The menu instance functions.
 
-MENU_DLL_EXPORT const char *Menu_GetTitle(IMenu_t *pMenu)
+MENU_DLL_EXPORT const char *Menu_GetTitle(IMenuHandle_t hMenu)
+{
+	IMenu_t *pMenu = FindMenu(hMenu);
+
+	return pMenu ? pMenu->GetTitle().Get() : nullptr;
+}
+
+MENU_DLL_EXPORT void Menu_SetTitle(IMenuHandle_t hMenu, const char *pszNewText)
+{
+	IMenu_t *pMenu = FindMenu(hMenu);
+
+	if(pMenu)
+	{
+		pMenu->GetTitleRef().Set(pszNewText);
+	}
+}
+
+MENU_DLL_EXPORT IMenuItemStyleFlags_t Menu_GetItemStyles(IMenuHandle_t hMenu, IMenuItemPosition_t iItem)
 {
-	return pMenu->GetTitleRef().Get();
+	IMenu_t *pMenu = FindMenu(hMenu);
+
+	if(!pMenu || !pMenu->GetItems().IsValidIndex(iItem))
+	{
+		return MENU_EXPORT_INVALID_ITEM_STYLES;
+	}
+
+	return pMenu->GetItems().Element(iItem).GetStyle();
 }
 
-MENU_DLL_EXPORT void Menu_SetTitle(IMenu_t *pMenu, const char *pszNewText)
+MENU_DLL_EXPORT const char *Menu_GetItemContent(IMenuHandle_t hMenu, IMenuItemPosition_t iItem)
 {
-	return pMenu->GetTitleRef().Set(pszNewText);
+	IMenu_t *pMenu = FindMenu(hMenu);
+
+	if(!pMenu || !pMenu->GetItems().IsValidIndex(iItem))
+	{
+		return nullptr;
+	}
+
+	return pMenu->GetItems().Element(iItem).Get();
 }
 
-MENU_DLL_EXPORT IMenuItemStyleFlags_t Menu_GetItemStyles(IMenu_t *pMenu, IMenuItemPosition_t iItem)
+MENU_DLL_EXPORT IMenuItemPosition_t Menu_AddItem(IMenuHandle_t hMenu, IMenuItemStyleFlags_t eFlags, const char *pszContent, IMenuItemHandler_t pfnItemHandler, void *pData)
 {
-	return pMenu->GetItemsRef().Element(iItem).GetStyle();
+	IMenu_t *pMenu = FindMenu(hMenu);
+
+	if(!pMenu)
+	{
+		return -1;
+	}
+
+	g_aMenuWrapper.AddHandler(std::make_pair(pMenu->GetItems().Count(), pMenu), pfnItemHandler);
+
+	return pMenu->AddItem({eFlags, pszContent, static_cast<IMenu::IItemHandler *>(&g_aMenuWrapper), pData});
 }
 
-MENU_DLL_EXPORT const char *Menu_GetItemContent(IMenu_t *pMenu, IMenuItemPosition_t iItem)
+MENU_DLL_EXPORT void Menu_RemoveItem(IMenuHandle_t hMenu, IMenuItemPosition_t iItem)
 {
-	return pMenu->GetItemsRef().Element(iItem).Get();
+	IMenu_t *pMenu = FindMenu(hMenu);
+
+	if(pMenu)
+	{
+		pMenu->RemoveItem(iItem);
+	}
 }
 
-MENU_DLL_EXPORT IMenuItemPosition_t Menu_AddItem(IMenu_t *pMenu, IMenuItemStyleFlags_t eFlags, const char *pszContent, IMenuItemHandler_t pfnItemHandler, void *pData)
+MENU_DLL_EXPORT bool Menu_SetItemStyles(IMenuHandle_t hMenu, IMenuItemPosition_t iItem, IMenuItemStyleFlags_t eNewStyles)
 {
-	auto &vecItems = pMenu->GetItemsRef();
+	IMenu_t *pMenu = FindMenu(hMenu);
+
+	return pMenu && pMenu->SetItemStyle(iItem, eNewStyles);
+}
 
-	g_aMenuWrapper.AddHandler(std::make_pair(vecItems.Count(), pMenu), pfnItemHandler);
+MENU_DLL_EXPORT bool Menu_SetItemContent(IMenuHandle_t hMenu, IMenuItemPosition_t iItem, const char *pszNewContent)
+{
+	IMenu_t *pMenu = FindMenu(hMenu);
 
-	return vecItems.AddToTail({eFlags, pszContent, static_cast<IMenu::IItemHandler *>(&g_aMenuWrapper), pData});
+	return pMenu && pMenu->SetItemContent(iItem, pszNewContent);
 }
 
-MENU_DLL_EXPORT void Menu_RemoveItem(IMenu_t *pMenu, IMenuItemPosition_t iItem)
+MENU_DLL_EXPORT IMenuItemControlFlags_t Menu_GetItemControls(IMenuHandle_t hMenu)
 {
-	pMenu->GetItemsRef().Remove(iItem);
+	IMenu_t *pMenu = FindMenu(hMenu);
+
+	return pMenu ? pMenu->GetItemControls() : IMenu::MENU_ITEM_CONTROL_FLAG_PANEL;
 }
 
-MENU_DLL_EXPORT IMenuItemControlFlags_t Menu_GetItemControls(IMenu_t *pMenu)
+MENU_DLL_EXPORT void Menu_SetItemControls(IMenuHandle_t hMenu, IMenuItemControlFlags_t eNewControls)
 {
-	return pMenu->GetItemControlsRef();
+	IMenu_t *pMenu = FindMenu(hMenu);
+
+	if(pMenu)
+	{
+		pMenu->GetItemControlsRef() = eNewControls;
+	}
 }
 
-MENU_DLL_EXPORT void Menu_SetItemControls(IMenu_t *pMenu, IMenuItemControlFlags_t eNewControls)
+MENU_DLL_EXPORT int Menu_GetPageCount(IMenuHandle_t hMenu)
 {
-	pMenu->GetItemControlsRef() = eNewControls;
+	IMenu_t *pMenu = FindMenu(hMenu);
+
+	return pMenu ? pMenu->GetPageCount() : 0;
 }
 
-MENU_DLL_EXPORT IMenuItemPosition_t Menu_GetCurrentPosition(IMenu_t *pMenu, CPlayerSlot aSlot)
+MENU_DLL_EXPORT IMenuItemPosition_t Menu_GetPageStartItem(IMenuHandle_t hMenu, int iPage)
 {
-	return pMenu->GetCurrentPosition(aSlot);
+	IMenu_t *pMenu = FindMenu(hMenu);
+
+	return pMenu ? pMenu->GetPageStartItem(iPage) : -1;
 }
-MENU_DLL_EXPORT IMenu_t *Menu_GetPlayerActiveMenu(IMenuSystem_t *pSystem, CPlayerSlot aSlot)
+
+MENU_DLL_EXPORT int Menu_GetPageOfItem(IMenuHandle_t hMenu, IMenuItemPosition_t iItem)
+{
+	IMenu_t *pMenu = FindMenu(hMenu);
+
+	return pMenu ? pMenu->GetPageOfItem(iItem) : -1;
+}
+
+MENU_DLL_EXPORT bool Menu_SetItemSource(IMenuHandle_t hMenu, IMenuItemSourceCount_t pfnCount, IMenuItemSourceContent_t pfnContent, IMenuItemHandler_t pfnItemHandler, void *pData)
+{
+	IMenu_t *pMenu = FindMenu(hMenu);
+
+	if(!pMenu)
+	{
+		return false;
+	}
+
+	if(!pfnCount || !pfnContent)
+	{
+		pMenu->SetItemSource(nullptr);
+		g_aMenuWrapper.RemoveItemSource(pMenu);
+
+		return true;
+	}
+
+	pMenu->SetItemSource(g_aMenuWrapper.SetItemSource(pMenu, {pfnCount, pfnContent, pfnItemHandler, pData}));
+
+	return true;
+}
+
+MENU_DLL_EXPORT void Menu_MarkItemsChanged(IMenuHandle_t hMenu, IMenuItemPosition_t iFirst, IMenuItemPosition_t iLast)
+{
+	IMenu_t *pMenu = FindMenu(hMenu);
+
+	if(pMenu)
+	{
+		pMenu->MarkItemsChanged(iFirst, iLast);
+	}
+}
+
+MENU_DLL_EXPORT IMenuItemPosition_t Menu_GetCurrentPosition(IMenuHandle_t hMenu, CPlayerSlot aSlot)
+{
+	IMenu_t *pMenu = FindMenu(hMenu);
+
+	return pMenu ? pMenu->GetCurrentPosition(aSlot) : -1;
+}
+
+MENU_DLL_EXPORT IMenuHandle_t Menu_GetPlayerActiveMenu(IMenuSystem_t *pSystem, CPlayerSlot aSlot)
 {
 	if (!pSystem)
 	{
-		return nullptr;
+		return MENU_INVALID_HANDLE;
 	}
 
 	auto *pPlayer = pSystem->GetPlayer(aSlot);
 	if (!pPlayer)
 	{
-		return nullptr;
+		return MENU_INVALID_HANDLE;
 	}
 
 	auto iActiveMenu = pPlayer->GetActiveMenuIndex();
 	if (iActiveMenu < 0)
 	{
-		return nullptr;
+		return MENU_INVALID_HANDLE;
 	}
 
 	auto &vecMenus = pPlayer->GetMenus();
 	if (iActiveMenu >= vecMenus.Count())
 	{
-		return nullptr;
+		return MENU_INVALID_HANDLE;
 	}
 
-	return vecMenus[iActiveMenu].m_pInstance;
+	return pSystem->GetInstanceHandle(vecMenus[iActiveMenu].m_pInstance);
 }
-
@@ -101,6 +101,11 @@ MenuSystem_Plugin::MenuSystem_Plugin()
     m_aEnableClientCommandDetailsConVar("mm_" META_PLUGIN_PREFIX "_enable_client_command_details", FCVAR_RELEASE | FCVAR_GAMEDLL, "Enable client command detial messages", false, true, false, true, true),
     m_aEnablePlayerRunCmdDetailsConVar("mm_" META_PLUGIN_PREFIX "_enable_player_runcmd_details", FCVAR_RELEASE | FCVAR_GAMEDLL, "Enable player usercmds detial messages", false, true, false, true, true),
     m_aEnableSilentCommandDispatchConVar("mm_" META_PLUGIN_PREFIX "_enable_silent_command_dispatch", FCVAR_RELEASE | FCVAR_GAMEDLL, "Enable dispatching silent commands to other plugins", true, true, false, true, true),
+    m_aMenuWarmPoolSizeConVar("mm_" META_PLUGIN_PREFIX "_menu_warm_pool_size", FCVAR_RELEASE | FCVAR_GAMEDLL, "Number of pre-constructed menu instances to keep for reuse", ABSOLUTE_PLAYER_LIMIT, true, 0, true, 1024),
+    m_aMenuEntityPoolSizeConVar("mm_" META_PLUGIN_PREFIX "_menu_entity_pool_size", FCVAR_RELEASE | FCVAR_GAMEDLL, "Number of hidden menu entities to keep for reuse", ABSOLUTE_PLAYER_LIMIT * MENU_MAX_ENTITIES, true, 0, true, 4096),
+    m_aPageCacheBudgetConVar("mm_" META_PLUGIN_PREFIX "_page_cache_budget_kb", FCVAR_RELEASE | FCVAR_GAMEDLL, "Kilobytes of the cached menu pages to keep, the least recently used are evicted (0 - unlimited)", 4096, true, 0, true, 1048576),
+    m_aPrerenderBudgetConVar("mm_" META_PLUGIN_PREFIX "_prerender_budget_us", FCVAR_RELEASE | FCVAR_GAMEDLL, "Microseconds of a frame to render the back and next pages of the active menus ahead (0 - disable)", 200, true, 0, true, 100000),
+    m_aRenderBudgetConVar("mm_" META_PLUGIN_PREFIX "_render_budget_us", FCVAR_RELEASE | FCVAR_GAMEDLL, "Microseconds of a frame to render the menus to display, the rest are queued for the next frames (0 - render all at once)", 2000, true, 0, true, 1000000),
 
     m_mapConVarCookies(DefLessFunc(const CUtlSymbolLarge)),
     m_mapLanguages(DefLessFunc(const CUtlSymbolLarge)),
@@ -121,7 +126,13 @@ MenuSystem_Plugin::MenuSystem_Plugin()
     m_aExitControlItem(CMenu::MENU_ITEM_FULL, "Exit"),
     m_aControls({&m_aBackControlItem, &m_aNextControlItem, &m_aExitControlItem}),
 
-    m_mapMenuHandlers(DefLessFunc(const IMenu *))
+    m_mapMenuEntityPools(DefLessFunc(const IMenuProfile *)),
+    m_nPooledMenuEntities(0), 
+
+    m_bSpawnBatching(false), 
+
+    m_iNextPrerenderClient(0), 
+    m_flFrameRenderTime(0.0)
 {
 	// Adds schema listeners.
 	{
@@ -402,6 +413,9 @@ bool MenuSystem_Plugin::Load(PluginId id, ISmmAPI *ismm, char *error, size_t max
 
 bool MenuSystem_Plugin::Unload(char *error, size_t maxlen)
 {
+	FlushCloseQueue();
+	PurgeMenuEntityPool();
+
 	{
 		auto *pNetServer = reinterpret_cast<CNetworkGameServerBase *>(g_pNetworkServerService->GetIGameServer());
 
@@ -490,8 +504,12 @@ bool MenuSystem_Plugin::Unload(char *error, size_t maxlen)
 		return false;
 	}
 
-	m_MenuAllocator.Purge();
-	m_mapMenuHandlers.Purge();
+	for(auto &vecQueue : m_arrRenderQueues)
+	{
+		vecQueue.Purge();
+	}
+
+	m_MenuAllocator.PurgeAndDeleteElements();
 
 	ConVar_Unregister();
 
@@ -766,6 +784,11 @@ bool MenuSystem_Plugin::DisplayInstanceToPlayer(IMenu *pMenu, CPlayerSlot aSlot,
 }
 
 bool MenuSystem_Plugin::CloseInstance(IMenu *pMenu)
+{
+	return QueueCloseMenu(pMenu, IMenuHandler::MenuEnd_Close);
+}
+
+bool MenuSystem_Plugin::CloseInstanceNow(IMenu *pMenu)
 {
 	auto *pMemBlock = m_MenuAllocator.FindMemBlock(pMenu);
 
@@ -779,14 +802,70 @@ bool MenuSystem_Plugin::CloseInstance(IMenu *pMenu)
 	CloseInternalMenu(pInternalMenu, IMenuHandler::MenuEnd_Close);
 	m_MenuAllocator.ReleaseByMemBlock(pMemBlock);
 
-	return false;
+	return true;
+}
+
+IMenu::Handle_t MenuSystem_Plugin::GetInstanceHandle(IMenu *pMenu)
+{
+	return m_MenuAllocator.FindHandle(pMenu);
+}
+
+IMenu *MenuSystem_Plugin::FindInstanceByHandle(IMenu::Handle_t hMenu)
+{
+	return static_cast<IMenu *>(m_MenuAllocator.FindByHandle(hMenu));
+}
+
+IMenuTemplate *MenuSystem_Plugin::CreateTemplate()
+{
+	return static_cast<IMenuTemplate *>(new CMenuTemplate(&m_aControls));
+}
+
+void MenuSystem_Plugin::ReleaseTemplate(IMenuTemplate *pTemplate)
+{
+	static_cast<CMenuTemplate *>(pTemplate)->Release();
+}
+
+IMenu *MenuSystem_Plugin::CreateInstanceFromTemplate(IMenuTemplate *pTemplate, IMenuProfile *pProfile, IMenuHandler *pHandler, bool bSharePages)
+{
+	CMenu *pInternalMenu = CreateInternalMenu(pProfile, pHandler);
+
+	if(pInternalMenu)
+	{
+		pInternalMenu->AttachTemplate(static_cast<CMenuTemplate *>(pTemplate), bSharePages);
+	}
+
+	return static_cast<IMenu *>(pInternalMenu);
+}
+
+IMenuTemplate *MenuSystem_Plugin::GetInstanceTemplate(IMenu *pMenu)
+{
+	CMenu *pInternalMenu = m_MenuAllocator.FindAndUpperCast(pMenu);
+
+	return pInternalMenu ? static_cast<IMenuTemplate *>(pInternalMenu->GetTemplate()) : nullptr;
+}
+
+int MenuSystem_Plugin::DisplayInstanceToPlayers(IMenu *pMenu, const CPlayerBitVec &bvPlayers, IMenu::Handle_t *pHandles, IMenu::ItemPosition_t iStartItem, int nManyTimes)
+{
+	std::fill_n(pHandles, ABSOLUTE_PLAYER_LIMIT, MENU_INVALID_HANDLE);
+
+	CMenu *pInternalMenu = m_MenuAllocator.FindAndUpperCast(pMenu);
+
+	if(!pInternalMenu)
+	{
+		return 0;
+	}
+
+	return DisplayInternalMenuToPlayers(pInternalMenu, bvPlayers, pHandles, iStartItem, nManyTimes);
 }
 
 CMenu *MenuSystem_Plugin::CreateInternalMenu(IMenuProfile *pProfile, IMenuHandler *pHandler)
 {
-	auto *pNewMenu = m_MenuAllocator.CreateInstance(static_cast<CMenu::CPointWorldText_Helper *>(this), &GetGameDataStorage().GetBaseEntity(), pProfile, static_cast<IMenuHandler *>(this), &m_aControls);
+	auto *pNewMenu = m_MenuAllocator.CreateInstance(static_cast<CMenu::CPointWorldText_Helper *>(this), &GetGameDataStorage().GetBaseEntity(), static_cast<ISample *>(this), pProfile, static_cast<IMenuHandler *>(this), &m_aControls);
 
-	m_mapMenuHandlers.InsertOrReplace(pNewMenu, pHandler);
+	if(pNewMenu)
+	{
+		pNewMenu->SetNextHandler(pHandler);
+	}
 
 	return pNewMenu;
 }
@@ -824,6 +903,8 @@ bool MenuSystem_Plugin::UpdatePlayerMenus(CPlayerSlot aSlot)
 
 	auto *pCSPlayerPawnBase = instance_upper_cast<CCSPlayerPawnBase *>(pPlayerPawn);
 
+	CMenu *pActiveInternalMenu = nullptr;
+
 	for(int i = 0; i < nMenuCount; i++)
 	{
 		const auto &[_, pMenu] = vecMenus.Element(i);
@@ -843,14 +924,161 @@ bool MenuSystem_Plugin::UpdatePlayerMenus(CPlayerSlot aSlot)
 				AttachMenuInstanceToCSPlayer(iShift, pInternalMenu, instance_upper_cast<CCSPlayerPawn *>(pCSPlayerPawnBase));
 			}
 
-			pInternalMenu->InternalDisplayAt(aSlot, pInternalMenu->GetCurrentPosition(aSlot), i == iActiveMenu ? IMenu::MENU_DISPLAY_DEFAULT : IMenu::MENU_DISPLAY_RENDER_BASE_UPDATE);
+			if(i == iActiveMenu)
+			{
+				pActiveInternalMenu = pInternalMenu;
+			}
+			else
+			{
+				QueueMenuRender(pInternalMenu, aSlot, IMenu::MENU_DISPLAY_RENDER_BASE_UPDATE); // Behind the active one, by the frame budget.
+			}
 		}
 	}
 
+	// The active one first.
+	if(pActiveInternalMenu)
+	{
+		RenderOrQueueMenu(pActiveInternalMenu, aSlot, IMenu::MENU_DISPLAY_DEFAULT);
+	}
+
 	return false;
 }
 
 bool MenuSystem_Plugin::DisplayInternalMenuToPlayer(CMenu *pInternalMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iStartItem, int nManyTimes)
+{
+	// Spawn now, even by a handler in the middle of a batch.
+	bool bSpawnBatching = std::exchange(m_bSpawnBatching, false);
+
+	bool bResult = PrepareInternalMenuDisplay(pInternalMenu, aSlot) && FinishInternalMenuDisplay(pInternalMenu, aSlot, iStartItem, nManyTimes);
+
+	m_bSpawnBatching = bSpawnBatching;
+
+	return bResult;
+}
+
+int MenuSystem_Plugin::DisplayInternalMenuToPlayers(CMenu *pInternalMenu, const CPlayerBitVec &bvPlayers, IMenu::Handle_t *pHandles, IMenu::ItemPosition_t iStartItem, int nManyTimes)
+{
+	// A menu holds the entities of one player, the others get the instances of its template.
+	CUtlVector<CPlayerSlot> vecSlots;
+
+	for(int iClient = 0; iClient < ABSOLUTE_PLAYER_LIMIT; iClient++)
+	{
+		if(bvPlayers.IsBitSet(iClient))
+		{
+			vecSlots.AddToTail(CPlayerSlot(iClient));
+		}
+	}
+
+	if(!vecSlots.Count())
+	{
+		return 0;
+	}
+
+	if(vecSlots.Count() > 1 && (!pInternalMenu->GetTemplate() || pInternalMenu->IsTemplateDetached()))
+	{
+		CLogger::WarningFormat("A menu without a template can be displayed to one player only. Got %d players\n", vecSlots.Count());
+
+		return 0;
+	}
+
+	if(m_bSpawnBatching) // Nested by a handler, display one by one.
+	{
+		int nDisplayed = 0;
+
+		FOR_EACH_VEC(vecSlots, i)
+		{
+			CMenu *pSlotMenu = i ? CreateInternalMenuCopy(pInternalMenu) : pInternalMenu;
+
+			if(!pSlotMenu)
+			{
+				continue;
+			}
+
+			if(DisplayInternalMenuToPlayer(pSlotMenu, vecSlots[i], iStartItem, nManyTimes))
+			{
+				pHandles[vecSlots[i].Get()] = m_MenuAllocator.FindHandle(static_cast<IMenu *>(pSlotMenu));
+				nDisplayed++;
+			}
+			else if(pSlotMenu != pInternalMenu)
+			{
+				m_MenuAllocator.ReleaseByInterface(static_cast<IMenu *>(pSlotMenu));
+			}
+		}
+
+		return nDisplayed;
+	}
+
+	CUtlVector<CPlayerSlot> vecPreparedSlots;
+
+	BeginSpawnBatch();
+
+	FOR_EACH_VEC(vecSlots, i)
+	{
+		CMenu *pSlotMenu = i ? CreateInternalMenuCopy(pInternalMenu) : pInternalMenu;
+
+		if(!pSlotMenu)
+		{
+			continue;
+		}
+
+		if(PrepareInternalMenuDisplay(pSlotMenu, vecSlots[i]))
+		{
+			vecPreparedSlots.AddToTail(vecSlots[i]);
+		}
+		else if(pSlotMenu != pInternalMenu)
+		{
+			m_MenuAllocator.ReleaseByInterface(static_cast<IMenu *>(pSlotMenu));
+		}
+	}
+
+	EndSpawnBatch();
+
+	// Own the batch, a handler may display the next menus.
+	CUtlVector<SpawnBatched_t> vecBatch;
+
+	vecBatch.Swap(m_vecSpawnBatch);
+	Assert(vecBatch.Count() == vecPreparedSlots.Count());
+
+	int nDisplayed = 0;
+
+	// Emit one by one, as the sequential displays do.
+	FOR_EACH_VEC(vecPreparedSlots, i)
+	{
+		const auto &aBatched = vecBatch[i];
+
+		CUtlVector<CEntityInstance *> vecEntities;
+
+		vecEntities.CopyArray(aBatched.m_arrEntities, aBatched.m_nEntities);
+		aBatched.m_pInternalMenu->Emit(vecEntities);
+
+		if(FinishInternalMenuDisplay(aBatched.m_pInternalMenu, vecPreparedSlots[i], iStartItem, nManyTimes))
+		{
+			pHandles[vecPreparedSlots[i].Get()] = m_MenuAllocator.FindHandle(static_cast<IMenu *>(aBatched.m_pInternalMenu));
+			nDisplayed++;
+		}
+	}
+
+	return nDisplayed;
+}
+
+CMenu *MenuSystem_Plugin::CreateInternalMenuCopy(CMenu *pInternalMenu)
+{
+	auto *pTemplate = pInternalMenu->GetTemplate();
+
+	Assert(pTemplate && !pInternalMenu->IsTemplateDetached());
+
+	CMenu *pNewMenu = CreateInternalMenu(const_cast<IMenuProfile *>(pInternalMenu->GetProfile()), pInternalMenu->GetNextHandler());
+
+	if(pNewMenu)
+	{
+		pNewMenu->AttachTemplate(pTemplate, pInternalMenu->IsSharingPages());
+		pNewMenu->SetItemSource(pInternalMenu->GetItemSource());
+	}
+
+	return pNewMenu;
+}
+
+bool MenuSystem_Plugin::PrepareInternalMenuDisplay(CMenu *pInternalMenu, CPlayerSlot aSlot)
 {
 	auto &aPlayer = GetPlayerData(aSlot);
 
@@ -893,9 +1121,14 @@ bool MenuSystem_Plugin::DisplayInternalMenuToPlayer(CMenu *pInternalMenu, CPlaye
 
 	SpawnMenuByEntityPosition(0, pInternalMenu, aSlot, pPlayerPawn);
 
-	auto &vecMenus = aPlayer.GetMenus();
+	return true;
+}
 
-	uint8 iTeam = CBaseEntity_Helper::GetTeamNumAccessor(pPlayerController);
+bool MenuSystem_Plugin::FinishInternalMenuDisplay(CMenu *pInternalMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iStartItem, int nManyTimes)
+{
+	auto &aPlayer = GetPlayerData(aSlot);
+
+	auto &vecMenus = aPlayer.GetMenus();
 
 	IMenu::Index_t &iActiveMenu = aPlayer.GetActiveMenuIndexRef();
 
@@ -911,57 +1144,149 @@ bool MenuSystem_Plugin::DisplayInternalMenuToPlayer(CMenu *pInternalMenu, CPlaye
 		vecMenus.InsertBefore(iActiveMenu, aMenuData);
 	}
 
-	UpdatePlayerMenus(aSlot);
+	pInternalMenu->SetViewerPosition(aSlot, iStartItem);
 
-	return pInternalMenu->InternalDisplayAt(aSlot, iStartItem);
+	UpdatePlayerMenus(aSlot); // Renders the new active menu, or queues it over the frame budget.
+
+	return true;
 }
 
-IMenuHandler *MenuSystem_Plugin::FindMenuHandler(IMenu *pMenu)
+int MenuSystem_Plugin::DestroyInternalMenuEntities(CMenu *pInternalMenu)
 {
-	int iFound = m_mapMenuHandlers.Find(pMenu);
+	int iDestroyedCount = ReleaseMenuEntities(pInternalMenu) ? m_pEntityManagerProviderAgent->ExecuteDestroyQueued() : 0;
+
+	pInternalMenu->CMenuBase::Purge();
 
-	return iFound == m_mapMenuHandlers.InvalidIndex() ? nullptr : m_mapMenuHandlers[iFound];
+	return iDestroyedCount;
 }
 
-int MenuSystem_Plugin::DestroyInternalMenuEntities(CMenu *pInternalMenu)
+void MenuSystem_Plugin::CloseInternalMenu(CMenu *pInternalMenu, IMenuHandler::EndReason_t eReason, bool bCleanupPlayer)
 {
-	for(auto *pMenuEntity : *pInternalMenu)
+	EnableRadarByMenu(pInternalMenu);
+	pInternalMenu->Close(eReason);
+	RemoveQueuedMenuRenders(pInternalMenu); // Of the other viewers too, the instance is released after.
+	DestroyInternalMenuEntities(pInternalMenu);
+	pInternalMenu->SetNextHandler(nullptr);
+
+	if(!bCleanupPlayer)
 	{
-		m_pEntityManagerProviderAgent->PushDestroyQueue(pMenuEntity);
+		return;
 	}
 
-	int iDestroyedCount = m_pEntityManagerProviderAgent->ExecuteDestroyQueued();
+	DetachMenuFromPlayers(pInternalMenu);
+}
 
-	if(iDestroyedCount)
+bool MenuSystem_Plugin::QueueCloseMenu(IMenu *pMenu, IMenuHandler::EndReason_t eReason)
+{
+	auto *pMemBlock = m_MenuAllocator.FindMemBlock(pMenu);
+
+	if(!pMemBlock)
 	{
-		pInternalMenu->CMenuBase::Purge();
+		return false;
 	}
 
-	return iDestroyedCount;
+	CMenu *pInternalMenu = m_MenuAllocator.GetInstanceByMemBlock(pMemBlock);
+
+	pMemBlock->MarkClosing();
+	m_vecCloseQueue.AddToTail({pInternalMenu, eReason});
+
+	EnableRadarByMenu(pInternalMenu);
+	RemoveQueuedMenuRenders(pInternalMenu);
+	DetachMenuFromPlayers(pInternalMenu);
+
+	return true;
 }
 
-bool MenuSystem_Plugin::CloseMenuHandler(IMenu *pMenu)
+void MenuSystem_Plugin::FlushCloseQueue()
 {
-	return m_mapMenuHandlers.Remove(pMenu);
+	// Handlers may close other menus while ending, so those are flushed with the next pass.
+	while(m_vecCloseQueue.Count())
+	{
+		CUtlVector<CloseQueued_t> vecQueue;
+
+		vecQueue.Swap(m_vecCloseQueue);
+
+		int nDestroyQueued = 0;
+
+		for(const auto &[pInternalMenu, eReason] : vecQueue)
+		{
+			pInternalMenu->Close(eReason);
+
+			if(m_pEntityManagerProviderAgent)
+			{
+				nDestroyQueued += ReleaseMenuEntities(pInternalMenu);
+			}
+		}
+
+		if(nDestroyQueued)
+		{
+			m_pEntityManagerProviderAgent->ExecuteDestroyQueued();
+		}
+
+		for(const auto &[pInternalMenu, _] : vecQueue)
+		{
+			pInternalMenu->CMenuBase::Purge();
+			pInternalMenu->SetNextHandler(nullptr);
+			m_MenuAllocator.ReleaseByMemBlock(m_MenuAllocator.FindMemBlock(static_cast<IMenu *>(pInternalMenu), true));
+		}
+	}
 }
 
-void MenuSystem_Plugin::CloseInternalMenu(CMenu *pInternalMenu, IMenuHandler::EndReason_t eReason, bool bCleanupPlayer)
+void MenuSystem_Plugin::EnableRadarByMenu(CMenu *pInternalMenu)
 {
-	pInternalMenu->Close(eReason);
-	DestroyInternalMenuEntities(pInternalMenu);
+	CConVarRef<int> aSVDisableRadar(MENUSYSTEM_SERVER_DISABLE_RADAR_CVAR_NAME);
 
-	IMenu *pMenu = static_cast<IMenu *>(pInternalMenu);
+	if(!aSVDisableRadar.Get())
+	{
+		IMenu *pMenu = static_cast<IMenu *>(pInternalMenu);
 
-	CloseMenuHandler(pMenu);
+		CRecipientFilter aFilter;
 
-	if(!bCleanupPlayer)
-	{
-		return;
+		for(const auto *pViewer : pInternalMenu->GetViewers())
+		{
+			CPlayerSlot aSlot = pViewer->m_aSlot;
+
+			auto &aPlayer = GetPlayerData(aSlot);
+
+			if(!aPlayer.IsConnected())
+			{
+				continue;
+			}
+
+			auto &vecMenus = aPlayer.GetMenus();
+
+			if(vecMenus.Count() != 1) // Pass mutlimenu.
+			{
+				continue;
+			}
+
+			if(pMenu == vecMenus[0].m_pInstance)
+			{
+				aFilter.AddRecipient(aSlot);
+			}
+		}
+
+		if(aFilter.GetRecipientCount()) // If found added recipient players.
+		{
+			CUtlVector<CVar_t> vecCVars(1);
+
+			vecCVars.AddToTail({MENUSYSTEM_SERVER_DISABLE_RADAR_CVAR_NAME, "0"});
+			SendSetConVarMessage(&aFilter, vecCVars);
+		}
 	}
+}
 
-	// Clean menu mention from players.
-	for(auto &aPlayer : m_aPlayers)
+void MenuSystem_Plugin::DetachMenuFromPlayers(CMenu *pInternalMenu)
+{
+	IMenu *pMenu = static_cast<IMenu *>(pInternalMenu);
+
+	// Stacks are a few menus deep, so a position is found by a short scan.
+	for(const auto *pViewer : pInternalMenu->GetViewers())
 	{
+		CPlayerSlot aSlot = pViewer->m_aSlot;
+
+		auto &aPlayer = GetPlayerData(aSlot);
+
 		if(!aPlayer.IsConnected())
 		{
 			continue;
@@ -977,14 +1302,12 @@ void MenuSystem_Plugin::CloseInternalMenu(CMenu *pInternalMenu, IMenuHandler::En
 
 			if(pMenu == pPlayerMenu)
 			{
-				if(i == iActiveMenu)
+				if(i <= iActiveMenu)
 				{
 					iActiveMenu--;
 				}
 
 				vecMenus.Remove(i);
-
-				break;
 			}
 		}
 
@@ -995,13 +1318,17 @@ void MenuSystem_Plugin::CloseInternalMenu(CMenu *pInternalMenu, IMenuHandler::En
 				iActiveMenu = 0;
 			}
 
-			UpdatePlayerMenus(aPlayer.GetServerSideClient()->GetPlayerSlot());
+			UpdatePlayerMenus(aSlot);
 		}
 	}
+
+	pInternalMenu->RemoveAllViewers();
 }
 
 void MenuSystem_Plugin::PurgeAllMenus()
 {
+	FlushCloseQueue();
+
 	for(auto &aPlayer : m_aPlayers)
 	{
 		if(!aPlayer.IsConnected())
@@ -1026,7 +1353,194 @@ void MenuSystem_Plugin::PurgeAllMenus()
 		vecMenus.Purge();
 	}
 
-	m_MenuAllocator.PurgeAndDeleteElements();
+	for(auto &vecQueue : m_arrRenderQueues)
+	{
+		vecQueue.Purge();
+	}
+
+	m_MenuAllocator.ReleaseAll();
+}
+
+void MenuSystem_Plugin::DumpMenuStats(CBufferString &sOutput)
+{
+	const auto aAllocatorStats = m_MenuAllocator.GetStats();
+
+	sOutput.AppendFormat("Menu allocator:\n");
+	sOutput.AppendFormat("\tLive: %d\n", aAllocatorStats.m_nLive);
+	sOutput.AppendFormat("\tFree: %d\n", aAllocatorStats.m_nFree);
+	sOutput.AppendFormat("\tHigh-water mark: %d\n", aAllocatorStats.m_nHighWaterMark);
+	sOutput.AppendFormat("\tBytes: %llu\n", static_cast<unsigned long long>(aAllocatorStats.m_nBytes));
+	sOutput.AppendFormat("\tWarm: %d/%d\n", aAllocatorStats.m_nWarm, aAllocatorStats.m_nWarmLimit);
+	sOutput.AppendFormat("\tPool hits: %d\n", aAllocatorStats.m_nPoolHits);
+	sOutput.AppendFormat("\tPool misses: %d\n", aAllocatorStats.m_nPoolMisses);
+	sOutput.AppendFormat("\tInstance size: %u (+%u per viewer)\n", static_cast<unsigned>(sizeof(CMenu)), static_cast<unsigned>(sizeof(CMenu::ViewerState_t)));
+
+	const auto &aPageCacheStats = CMenu::GetPageBudget().GetStats();
+
+	sOutput.AppendFormat("Menu page cache:\n");
+	sOutput.AppendFormat("\tPages: %d\n", aPageCacheStats.m_nPages);
+	sOutput.AppendFormat("\tBytes: %llu/%llu\n", static_cast<unsigned long long>(aPageCacheStats.m_nBytes), static_cast<unsigned long long>(aPageCacheStats.m_nLimit));
+	sOutput.AppendFormat("\tHits: %llu\n", static_cast<unsigned long long>(aPageCacheStats.m_nHits));
+	sOutput.AppendFormat("\tMisses: %llu\n", static_cast<unsigned long long>(aPageCacheStats.m_nMisses));
+	sOutput.AppendFormat("\tEvictions: %llu\n", static_cast<unsigned long long>(aPageCacheStats.m_nEvictions));
+	sOutput.AppendFormat("\tPage size: %u (+text in the arena)\n", static_cast<unsigned>(sizeof(CMenu::CPage)));
+	sOutput.AppendFormat("\tPrerendered: %llu (%llu displayed)\n", static_cast<unsigned long long>(aPageCacheStats.m_nPrerenders), static_cast<unsigned long long>(aPageCacheStats.m_nPrerenderHits));
+	sOutput.AppendFormat("\tPrerender deferrals: %llu (budget %d us)\n", static_cast<unsigned long long>(aPageCacheStats.m_nPrerenderDeferrals), m_aPrerenderBudgetConVar.Get());
+
+	const auto &aRenderQueueStats = m_aRenderQueueStats;
+
+	sOutput.AppendFormat("Menu render queue:\n");
+	sOutput.AppendFormat("\tDepth: %d active, %d base (peak %d)\n", m_arrRenderQueues[RENDER_QUEUE_ACTIVE].Count(), m_arrRenderQueues[RENDER_QUEUE_BASE].Count(), aRenderQueueStats.m_nPeakDepth);
+	sOutput.AppendFormat("\tRendered: %llu\n", static_cast<unsigned long long>(aRenderQueueStats.m_nRendered));
+	sOutput.AppendFormat("\tDeferred frames: %llu\n", static_cast<unsigned long long>(aRenderQueueStats.m_nDeferredFrames));
+	sOutput.AppendFormat("\tFrame time: %.0f us (peak %.0f us, budget %d us)\n", aRenderQueueStats.m_flLastFrameTime * 1e6, aRenderQueueStats.m_flPeakFrameTime * 1e6, m_aRenderBudgetConVar.Get());
+
+	const auto &aEntityPoolStats = m_aMenuEntityPoolStats;
+
+	sOutput.AppendFormat("Menu entity pool:\n");
+	sOutput.AppendFormat("\tPooled: %d/%d\n", m_nPooledMenuEntities, m_aMenuEntityPoolSizeConVar.Get());
+	sOutput.AppendFormat("\tReused sets: %d\n", aEntityPoolStats.m_nReused);
+	sOutput.AppendFormat("\tSpawned sets: %d\n", aEntityPoolStats.m_nSpawned);
+	sOutput.AppendFormat("\tBatched sets: %d (by %d flushes)\n", aEntityPoolStats.m_nBatchedSets, aEntityPoolStats.m_nBatchFlushes);
+	sOutput.AppendFormat("\tReturned: %d\n", aEntityPoolStats.m_nReturned);
+	sOutput.AppendFormat("\tDestroyed: %d\n", aEntityPoolStats.m_nDestroyed);
+}
+
+bool MenuSystem_Plugin::TakePooledMenuEntities(const IMenuProfile *pProfile, CUtlVector<CEntityInstance *> &vecEntities)
+{
+	auto iFound = m_mapMenuEntityPools.Find(pProfile);
+
+	if(iFound == m_mapMenuEntityPools.InvalidIndex())
+	{
+		return false;
+	}
+
+	auto &arrLayers = m_mapMenuEntityPools.Element(iFound)->m_vecLayers;
+
+	const int nLayers = pProfile->GetLayers();
+
+	for(int i = 0; i < nLayers; i++)
+	{
+		if(!arrLayers[i].Count())
+		{
+			return false;
+		}
+	}
+
+	for(int i = 0; i < nLayers; i++)
+	{
+		auto &vecLayer = arrLayers[i];
+
+		int iLast = vecLayer.Count() - 1;
+
+		m_bvPooledMenuEntities.Clear(vecLayer[iLast]->GetEntityIndex().Get());
+		vecEntities.AddToTail(vecLayer[iLast]);
+		vecLayer.FastRemove(iLast);
+	}
+
+	m_nPooledMenuEntities -= nLayers;
+
+	return true;
+}
+
+int MenuSystem_Plugin::ReleaseMenuEntities(CMenu *pInternalMenu)
+{
+	auto &aBaseEntity = GetGameDataStorage().GetBaseEntity();
+
+	const int nPoolSize = m_aMenuEntityPoolSizeConVar.Get();
+
+	const IMenuProfile *pProfile = pInternalMenu->GetProfile();
+
+	const auto &vecEntities = pInternalMenu->GetActiveEntities();
+
+	int nPushed = 0;
+
+	MenuEntityPool_t *pPool = nullptr;
+
+	const int nLayers = vecEntities.Count();
+
+	if(pProfile && nLayers == pProfile->GetLayers() && m_nPooledMenuEntities + nLayers <= nPoolSize)
+	{
+		auto iFound = m_mapMenuEntityPools.Find(pProfile);
+
+		pPool = iFound == m_mapMenuEntityPools.InvalidIndex() ? m_mapMenuEntityPools.Element(m_mapMenuEntityPools.Insert(pProfile, new MenuEntityPool_t)) : m_mapMenuEntityPools.Element(iFound);
+	}
+
+	variant_t aEmptyVariant {};
+
+	FOR_EACH_VEC(vecEntities, i)
+	{
+		auto *pEntity = vecEntities[i];
+
+		if(!pPool)
+		{
+			m_pEntityManagerProviderAgent->PushDestroyQueue(pEntity);
+			nPushed++;
+
+			continue;
+		}
+
+		// Hide in place. Colours and materials stay as the profile layer spawned them.
+		{
+			auto aTextAccessor = GetMessageTextAccessor(instance_upper_cast<CPointWorldText *>(pEntity));
+
+			V_strncpy(aTextAccessor, "", aTextAccessor.GetSize());
+			aTextAccessor.MarkNetworkChanged();
+		}
+
+		aBaseEntity.AcceptInput(pEntity, "ClearParent", NULL, NULL, &aEmptyVariant, 0);
+		aBaseEntity.AcceptInput(pEntity, "Disable", NULL, NULL, &aEmptyVariant, 0);
+		pPool->m_vecLayers[i].AddToTail(pEntity);
+		m_bvPooledMenuEntities.Set(pEntity->GetEntityIndex().Get());
+	}
+
+	pInternalMenu->ResetSentTexts();
+
+	if(pPool)
+	{
+		m_nPooledMenuEntities += nLayers;
+		m_aMenuEntityPoolStats.m_nReturned += nLayers;
+	}
+	else
+	{
+		m_aMenuEntityPoolStats.m_nDestroyed += nPushed;
+	}
+
+	return nPushed;
+}
+
+void MenuSystem_Plugin::PurgeMenuEntityPool(bool bDestroy)
+{
+	int nPushed = 0;
+
+	FOR_EACH_MAP_FAST(m_mapMenuEntityPools, i)
+	{
+		auto *pPool = m_mapMenuEntityPools.Element(i);
+
+		if(bDestroy && m_pEntityManagerProviderAgent)
+		{
+			for(const auto &vecLayer : pPool->m_vecLayers)
+			{
+				for(auto *pEntity : vecLayer)
+				{
+					m_pEntityManagerProviderAgent->PushDestroyQueue(pEntity);
+					nPushed++;
+				}
+			}
+		}
+
+		delete pPool;
+	}
+
+	m_mapMenuEntityPools.Purge();
+	m_nPooledMenuEntities = 0;
+	m_bvPooledMenuEntities.ClearAll();
+
+	if(nPushed)
+	{
+		m_pEntityManagerProviderAgent->ExecuteDestroyQueued();
+		m_aMenuEntityPoolStats.m_nDestroyed += nPushed;
+	}
 }
 
 void MenuSystem_Plugin::OnMenuStart(IMenu *pMenu)
@@ -1036,7 +1550,7 @@ void MenuSystem_Plugin::OnMenuStart(IMenu *pMenu)
 		CLogger::DetailedFormat("%s(pMenu = %p)\n", __FUNCTION__, pMenu);
 	}
 
-	auto *pHandler = FindMenuHandler(pMenu);
+	auto *pHandler = GetMenuHandler(pMenu);
 
 	if(pHandler)
 	{
@@ -1051,7 +1565,7 @@ void MenuSystem_Plugin::OnMenuDisplay(IMenu *pMenu, CPlayerSlot aSlot)
 		CLogger::DetailedFormat("%s(pMenu = %p, iClient = %d)\n", __FUNCTION__, pMenu, aSlot.GetClientIndex());
 	}
 
-	auto *pHandler = FindMenuHandler(pMenu);
+	auto *pHandler = GetMenuHandler(pMenu);
 
 	if(pHandler)
 	{
@@ -1066,7 +1580,7 @@ void MenuSystem_Plugin::OnMenuSelect(IMenu *pMenu, CPlayerSlot aSlot, IMenu::Ite
 		CLogger::DetailedFormat("%s(pMenu = %p, iClient = %d, iItem = %d)\n", __FUNCTION__, pMenu, aSlot.GetClientIndex(), iItem);
 	}
 
-	auto *pHandler = FindMenuHandler(pMenu);
+	auto *pHandler = GetMenuHandler(pMenu);
 
 	if(pHandler)
 	{
@@ -1086,7 +1600,7 @@ void MenuSystem_Plugin::OnMenuEnd(IMenu *pMenu, EndReason_t eReason)
 		CLogger::DetailedFormat("%s(pMenu = %p, eReason = %d)\n", __FUNCTION__, pMenu, eReason);
 	}
 
-	auto *pHandler = FindMenuHandler(pMenu);
+	auto *pHandler = GetMenuHandler(pMenu);
 
 	if(pHandler)
 	{
@@ -1096,21 +1610,8 @@ void MenuSystem_Plugin::OnMenuEnd(IMenu *pMenu, EndReason_t eReason)
 
 bool MenuSystem_Plugin::OnMenuExitButton(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iItem)
 {
-	auto *pMenuMemBlock = m_MenuAllocator.FindMemBlock(pMenu);
-
-	if(!pMenuMemBlock)
-	{
-		return false;
-	}
-
-	CMenu *pInternalMenu = m_MenuAllocator.GetInstanceByMemBlock(pMenuMemBlock);
-
-	CloseInternalMenu(pInternalMenu, IMenuHandler::MenuEnd_Exit);
-	m_MenuAllocator.ReleaseByMemBlock(pMenuMemBlock);
-
-	UpdatePlayerMenus(aSlot);
-
-	return true;
+	// Off the player stacks at once, which updates the rest of them. Only the teardown waits for the flush.
+	return QueueCloseMenu(pMenu, IMenuHandler::MenuEnd_Exit);
 }
 
 bool MenuSystem_Plugin::OnMenuSwitch(CPlayerSlot aSlot)
@@ -1134,46 +1635,7 @@ void MenuSystem_Plugin::OnMenuDestroy(IMenu *pMenu)
 		CLogger::DetailedFormat("%s(pMenu = %p)\n", __FUNCTION__, pMenu);
 	}
 
-	// Enable a radar back.
-	CConVarRef<int> aSVDisableRadar(MENUSYSTEM_SERVER_DISABLE_RADAR_CVAR_NAME);
-
-	if(!aSVDisableRadar.Get())
-	{
-		bool bSendDisableRadar = true;
-
-		CRecipientFilter aFilter;
-
-		// Find menu interface in players.
-		for(auto &aPlayer : m_aPlayers)
-		{
-			if(!aPlayer.IsConnected())
-			{
-				continue;
-			}
-
-			auto &vecMenus = aPlayer.GetMenus();
-
-			if(vecMenus.Count() != 1) // Pass mutlimenu.
-			{
-				continue;
-			}
-
-			if(pMenu == vecMenus[0].m_pInstance)
-			{
-				aFilter.AddRecipient(aPlayer.GetServerSideClient()->GetPlayerSlot());
-			}
-		}
-
-		if(aFilter.GetRecipientCount()) // If found added recipient players.
-		{
-			CUtlVector<CVar_t> vecCVars(1);
-
-			vecCVars.AddToTail({MENUSYSTEM_SERVER_DISABLE_RADAR_CVAR_NAME, "0"});
-			SendSetConVarMessage(&aFilter, vecCVars);
-		}
-	}
-
-	auto *pHandler = FindMenuHandler(pMenu);
+	auto *pHandler = GetMenuHandler(pMenu);
 
 	if(pHandler)
 	{
@@ -1181,87 +1643,95 @@ void MenuSystem_Plugin::OnMenuDestroy(IMenu *pMenu)
 	}
 }
 
-void MenuSystem_Plugin::OnMenuDrawTitle(IMenu *pMenu, CPlayerSlot aSlot, IMenu::Title_t &aTitle)
+void MenuSystem_Plugin::OnMenuDisplayItemView(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iItem, IMenu::ItemView_t &aView)
 {
 	if(CLogger::IsChannelEnabled(LV_DETAILED))
 	{
-		CLogger::DetailedFormat("%s(pMenu = %p, iClient = %d, sTitle = \"%s\")\n", __FUNCTION__, pMenu, aSlot.GetClientIndex(), aTitle.Get());
+		CLogger::DetailedFormat("%s(pMenu = %p, iClient = %d, iItem = %d, aView = \"%s\")\n", __FUNCTION__, pMenu, aSlot.GetClientIndex(), iItem, aView.Get());
 	}
 
-	const char *pszPhraseName = aTitle.Get();
-
-	int iFound;
+	bool bPlayerAreTranslated = false;
 
-	if(Translations::FindPhrase(pszPhraseName, iFound))
+	if(aSlot.IsValid())
 	{
-		const auto &aTranslationsPhrase = Translations::GetPhrase(iFound);
-
-		const char *pszServerContryCode = m_aServerLanguage.GetCountryCode();
-
-		const Translations::CPhrase::CContent *pContent;
+		auto &aPlayer = GetPlayerData(aSlot);
 
-		if(aTranslationsPhrase.Find(pszServerContryCode, pContent))
+		if(aPlayer.IsConnected())
 		{
-			aTitle.m_sText = *pContent;
+			bPlayerAreTranslated = aPlayer.OnMenuDisplayItem(pMenu, aSlot, iItem, aView);
 		}
 	}
 
-	auto *pHandler = FindMenuHandler(pMenu);
-
-	if(pHandler)
+	if(!bPlayerAreTranslated)
 	{
-		pHandler->OnMenuDrawTitle(pMenu, aSlot, aTitle);
-	}
-}
+		const char *pszPhraseName = aView.Get();
 
-void MenuSystem_Plugin::OnMenuDisplayItem(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iItem, IMenu::Item_t &aData)
-{
-	if(CLogger::IsChannelEnabled(LV_DETAILED))
-	{
-		CLogger::DetailedFormat("%s(pMenu = %p, iClient = %d, iItem = %d, aData = \"%s\")\n", __FUNCTION__, pMenu, aSlot.GetClientIndex(), iItem, aData.Get());
-	}
+		int iFound;
 
-	bool bPlayerAreTranslated = false;
+		if(Translations::FindPhrase(pszPhraseName, iFound))
+		{
+			const auto &aTranslationsPhrase = Translations::GetPhrase(iFound);
 
-	if(aSlot.IsValid())
-	{
-		auto &aPlayer = GetPlayerData(aSlot);
+			const char *pszServerContryCode = m_aServerLanguage.GetCountryCode();
 
-		if(aPlayer.IsConnected())
-		{
-			bPlayerAreTranslated = aPlayer.OnMenuDisplayItem(pMenu, aSlot, iItem, aData);
+			const Translations::CPhrase::CContent *pContent;
+
+			if(aTranslationsPhrase.Find(pszServerContryCode, pContent))
+			{
+				aView.SetRef(*pContent);
+			}
 		}
 	}
 
-	if(!bPlayerAreTranslated)
+	auto *pHandler = GetMenuHandler(pMenu);
+
+	if(pHandler)
+	{
+		pHandler->OnMenuDisplayItemView(pMenu, aSlot, iItem, aView);
+	}
+}
+
+void MenuSystem_Plugin::OnMenuDrawTitleView(IMenu *pMenu, CPlayerSlot aSlot, IMenu::TitleView_t &aView)
+{
+	if(CLogger::IsChannelEnabled(LV_DETAILED))
 	{
-		const char *pszPhraseName = aData.Get();
+		CLogger::DetailedFormat("%s(pMenu = %p, iClient = %d, aView = \"%s\")\n", __FUNCTION__, pMenu, aSlot.GetClientIndex(), aView.Get());
+	}
 
-		int iFound;
+	const char *pszPhraseName = aView.Get();
 
-		if(Translations::FindPhrase(pszPhraseName, iFound))
-		{
-			const auto &aTranslationsPhrase = Translations::GetPhrase(iFound);
+	int iFound;
 
-			const char *pszServerContryCode = m_aServerLanguage.GetCountryCode();
+	if(Translations::FindPhrase(pszPhraseName, iFound))
+	{
+		const auto &aTranslationsPhrase = Translations::GetPhrase(iFound);
 
-			const Translations::CPhrase::CContent *pContent;
+		const char *pszServerContryCode = m_aServerLanguage.GetCountryCode();
 
-			if(aTranslationsPhrase.Find(pszServerContryCode, pContent))
-			{
-				aData.m_sContent = *pContent;
-			}
+		const Translations::CPhrase::CContent *pContent;
+
+		if(aTranslationsPhrase.Find(pszServerContryCode, pContent))
+		{
+			aView.SetRef(*pContent);
 		}
 	}
 
-	auto *pHandler = FindMenuHandler(pMenu);
+	auto *pHandler = GetMenuHandler(pMenu);
 
 	if(pHandler)
 	{
-		pHandler->OnMenuDisplayItem(pMenu, aSlot, iItem, aData);
+		pHandler->OnMenuDrawTitleView(pMenu, aSlot, aView);
 	}
 }
 
+bool MenuSystem_Plugin::IsMenuRenderSlotSpecific(IMenu *pMenu, CPlayerSlot aSlot)
+{
+	// Own translations depend on the player language only, which is a part of the page key.
+	auto *pHandler = GetMenuHandler(pMenu);
+
+	return pHandler && pHandler->IsMenuRenderSlotSpecific(pMenu, aSlot);
+}
+
 bool MenuSystem_Plugin::Init()
 {
 	if(CLogger::IsChannelEnabled(LS_DETAILED))
@@ -1305,6 +1775,15 @@ GS_EVENT_MEMBER(MenuSystem_Plugin, GameActivate)
 			CLogger::WarningFormat("%s\n", sMessage);
 		}
 	}
+
+	m_MenuAllocator.SetWarmLimit(m_aMenuWarmPoolSizeConVar.Get());
+
+	int nPrewarmed = m_MenuAllocator.Prewarm(static_cast<CMenu::CPointWorldText_Helper *>(this), &GetGameDataStorage().GetBaseEntity(), static_cast<ISample *>(this));
+
+	if(CLogger::IsChannelEnabled(LV_DETAILED))
+	{
+		CLogger::DetailedFormat("Pre-warmed %d menu instances\n", nPrewarmed);
+	}
 }
 
 GS_EVENT_MEMBER(MenuSystem_Plugin, GameDeactivate)
@@ -1315,6 +1794,8 @@ GS_EVENT_MEMBER(MenuSystem_Plugin, GameDeactivate)
 	{
 		CLogger::WarningFormat("%s\n", sMessage);
 	}
+
+	m_MenuAllocator.Compact();
 }
 
 GS_EVENT_MEMBER(MenuSystem_Plugin, ServerPreEntityThink)
@@ -1325,6 +1806,8 @@ GS_EVENT_MEMBER(MenuSystem_Plugin, ServerPreEntityThink)
 GS_EVENT_MEMBER(MenuSystem_Plugin, GameFrameBoundary)
 {
 	// Check the lifecycle of timed menus.
+	CUtlVector<IMenu *> vecExpiredMenus;
+
 	for(auto &aPlayer : m_aPlayers)
 	{
 		if(!aPlayer.IsConnected())
@@ -1332,53 +1815,240 @@ GS_EVENT_MEMBER(MenuSystem_Plugin, GameFrameBoundary)
 			continue;
 		}
 
-		IMenu::Index_t &iActiveMenu = aPlayer.GetActiveMenuIndexRef();
-
-		auto &vecMenus = aPlayer.GetMenus();
-
-		bool bNeedUpdate = false;
+		const auto &vecMenus = aPlayer.GetMenus();
 
 		FOR_EACH_VEC_BACK(vecMenus, i)
 		{
-			const auto &[nEndTimestamp, pMenu] = vecMenus.Element(i);
+			const auto [nEndTimestamp, pMenu] = vecMenus.Element(i);
 
 			if(!nEndTimestamp || nEndTimestamp > Plat_GetTime())
 			{
 				continue;
 			}
 
-			auto *pMemBlock = m_MenuAllocator.FindMemBlock(pMenu);
+			vecExpiredMenus.AddToTail(pMenu);
+		}
+	}
 
-			if(!pMemBlock)
+	// Out of the loops, a close detaches the menu from all the stacks and updates them.
+	for(auto *pMenu : vecExpiredMenus)
+	{
+		QueueCloseMenu(pMenu, IMenuHandler::MenuEnd_Timeout); // Already closing ones are skipped.
+	}
+
+	FlushCloseQueue();
+
+	CMenu::GetPageBudget().SetLimit(static_cast<uintp>(m_aPageCacheBudgetConVar.Get()) * 1024);
+
+	// Re-render the changed items for the players who see them.
+	for(auto &aPlayer : m_aPlayers)
+	{
+		if(!aPlayer.IsConnected())
+		{
+			continue;
+		}
+
+		for(const auto &[_, pMenu] : aPlayer.GetMenus())
+		{
+			CMenu *pInternalMenu = m_MenuAllocator.FindAndUpperCast(pMenu);
+
+			if(pInternalMenu && pInternalMenu->HasItemChanges())
+			{
+				pInternalMenu->FlushItemChanges();
+			}
+		}
+	}
+
+	// The queued ones in the rest of the frame budget.
+	const int nRenderBudget = m_aRenderBudgetConVar.Get();
+
+	DrainRenderQueue(nRenderBudget > 0 ? nRenderBudget * 1e-6 - m_flFrameRenderTime : FLT_MAX); // The rest at once when disabled.
+
+	auto &aRenderQueueStats = m_aRenderQueueStats;
+
+	aRenderQueueStats.m_flLastFrameTime = m_flFrameRenderTime;
+	aRenderQueueStats.m_flPeakFrameTime = MAX(aRenderQueueStats.m_flPeakFrameTime, m_flFrameRenderTime);
+	m_flFrameRenderTime = 0.0;
+
+	// The rest is ahead of "Back" and "Next", so a flip finds its page cached.
+	const int nPrerenderBudget = m_aPrerenderBudgetConVar.Get();
+
+	if(nPrerenderBudget > 0)
+	{
+		PrerenderAdjacentPages(nPrerenderBudget * 1e-6);
+	}
+}
+
+bool MenuSystem_Plugin::RenderOrQueueMenu(CMenu *pInternalMenu, CPlayerSlot aSlot, IMenu::DisplayFlags_t eFlags)
+{
+	const int nRenderBudget = m_aRenderBudgetConVar.Get();
+
+	if(nRenderBudget > 0 && ((eFlags & IMenu::MENU_DISPLAY_RENDER_BASE) || m_flFrameRenderTime >= nRenderBudget * 1e-6))
+	{
+		QueueMenuRender(pInternalMenu, aSlot, eFlags);
+
+		return false;
+	}
+
+	const double flStartTime = Plat_FloatTime();
+
+	pInternalMenu->InternalDisplayAt(aSlot, pInternalMenu->GetCurrentPosition(aSlot), eFlags);
+	m_flFrameRenderTime += Plat_FloatTime() - flStartTime;
+	m_aRenderQueueStats.m_nRendered++;
+
+	return true;
+}
+
+void MenuSystem_Plugin::QueueMenuRender(CMenu *pInternalMenu, CPlayerSlot aSlot, IMenu::DisplayFlags_t eFlags)
+{
+	const RenderQueue_t eQueue = (eFlags & IMenu::MENU_DISPLAY_RENDER_BASE) ? RENDER_QUEUE_BASE : RENDER_QUEUE_ACTIVE;
+
+	// A menu is rendered once per player, by the last flags.
+	for(int iQueue = 0; iQueue < RENDER_QUEUE_MAX; iQueue++)
+	{
+		auto &vecQueue = m_arrRenderQueues[iQueue];
+
+		FOR_EACH_VEC(vecQueue, i)
+		{
+			auto &aQueued = vecQueue[i];
+
+			if(aQueued.m_pInternalMenu != pInternalMenu || aQueued.m_aSlot.Get() != aSlot.Get())
 			{
 				continue;
 			}
 
-			if(i == iActiveMenu)
+			if(iQueue == eQueue)
 			{
-				iActiveMenu--;
-				bNeedUpdate = true;
+				aQueued.m_eFlags = eFlags;
+
+				return;
 			}
 
-			vecMenus.Remove(i);
+			vecQueue.Remove(i);
 
-			CMenu *pInternalMenu = m_MenuAllocator.GetInstanceByMemBlock(pMemBlock);
+			break;
+		}
+	}
 
-			CloseInternalMenu(pInternalMenu, IMenuHandler::MenuEnd_Timeout, false);
-			m_MenuAllocator.ReleaseByMemBlock(pMemBlock);
+	m_arrRenderQueues[eQueue].AddToTail({pInternalMenu, aSlot, eFlags});
+
+	auto &aRenderQueueStats = m_aRenderQueueStats;
+
+	aRenderQueueStats.m_nPeakDepth = MAX(aRenderQueueStats.m_nPeakDepth, m_arrRenderQueues[RENDER_QUEUE_ACTIVE].Count() + m_arrRenderQueues[RENDER_QUEUE_BASE].Count());
+}
+
+void MenuSystem_Plugin::RemoveQueuedMenuRenders(const CMenu *pInternalMenu)
+{
+	for(auto &vecQueue : m_arrRenderQueues)
+	{
+		FOR_EACH_VEC_BACK(vecQueue, i)
+		{
+			if(vecQueue[i].m_pInternalMenu == pInternalMenu)
+			{
+				vecQueue.Remove(i);
+			}
 		}
+	}
+}
 
-		// Update player menus if the active menu was closed due to timeout
-		if(bNeedUpdate && vecMenus.Count())
+int MenuSystem_Plugin::DrainRenderQueue(double flBudget)
+{
+	const double flStartTime = Plat_FloatTime(), 
+	             flDeadline = flStartTime + flBudget;
+
+	int nRendered = 0;
+
+	for(auto &vecQueue : m_arrRenderQueues)
+	{
+		int nDone = 0;
+
+		for(; nDone < vecQueue.Count(); nDone++)
 		{
-			if(iActiveMenu == MENU_INVLID_INDEX)
+			if(nRendered && Plat_FloatTime() >= flDeadline)
 			{
-				iActiveMenu = 0;
+				break;
+			}
+
+			const auto &[pInternalMenu, aSlot, eFlags] = vecQueue[nDone];
+
+			auto &aPlayer = GetPlayerData(aSlot);
+
+			// The player may have left or closed it since.
+			if(!aPlayer.IsConnected() || !pInternalMenu->FindViewer(aSlot))
+			{
+				continue;
+			}
+
+			pInternalMenu->InternalDisplayAt(aSlot, pInternalMenu->GetCurrentPosition(aSlot), eFlags);
+			nRendered++;
+		}
+
+		vecQueue.RemoveMultipleFromHead(nDone);
+
+		if(vecQueue.Count())
+		{
+			m_aRenderQueueStats.m_nDeferredFrames++;
+
+			break;
+		}
+	}
+
+	m_flFrameRenderTime += Plat_FloatTime() - flStartTime;
+	m_aRenderQueueStats.m_nRendered += nRendered;
+
+	return nRendered;
+}
+
+int MenuSystem_Plugin::PrerenderAdjacentPages(double flBudget)
+{
+	const double flDeadline = Plat_FloatTime() + flBudget;
+
+	int nRendered = 0;
+
+	for(int n = 0; n < ABSOLUTE_PLAYER_LIMIT; n++)
+	{
+		const int iClient = (m_iNextPrerenderClient + n) % ABSOLUTE_PLAYER_LIMIT;
+
+		auto &aPlayer = m_aPlayers[iClient];
+
+		if(!aPlayer.IsConnected())
+		{
+			continue;
+		}
+
+		const auto &vecMenus = aPlayer.GetMenus();
+
+		const IMenu::Index_t iActiveMenu = aPlayer.GetActiveMenuIndex();
+
+		if(!vecMenus.IsValidIndex(iActiveMenu))
+		{
+			continue;
+		}
+
+		CMenu *pInternalMenu = m_MenuAllocator.FindAndUpperCast(vecMenus[iActiveMenu].m_pInstance);
+
+		if(!pInternalMenu)
+		{
+			continue;
+		}
+
+		for(int iOffset : {1, -1}) // "Next" is more likely.
+		{
+			if(Plat_FloatTime() >= flDeadline)
+			{
+				m_iNextPrerenderClient = iClient;
+				CMenu::GetPageBudget().CountPrerenderDeferral();
+
+				return nRendered;
 			}
 
-			UpdatePlayerMenus(aPlayer.GetServerSideClient()->GetPlayerSlot());
+			nRendered += pInternalMenu->PrerenderAdjacentPage(CPlayerSlot(iClient), iOffset);
 		}
 	}
+
+	m_iNextPrerenderClient = 0;
+
+	return nRendered;
 }
 
 void MenuSystem_Plugin::OnSpawnGroupAllocated(SpawnGroupHandle_t hSpawnGroup, ISpawnGroup *pSpawnGroup)
@@ -1460,6 +2130,7 @@ void MenuSystem_Plugin::OnSpawnGroupDestroyed(SpawnGroupHandle_t hSpawnGroup)
 	}
 
 	PurgeAllMenus();
+	PurgeMenuEntityPool(false); // Entities go with the spawn group.
 
 	m_pMySpawnGroupInstance = nullptr;
 }
@@ -2006,8 +2677,72 @@ void MenuSystem_Plugin::SpawnEntities(const CUtlVector<CEntityKeyValues *> &vecK
 	}
 }
 
+// Sets up the spawned menu entities.
+class CMenuEntityListener : public IEntityManager::IProviderAgent::IEntityListener
+{
+public:
+	CMenuEntityListener(MenuSystem_Plugin *pInitPlugin)
+	 :  m_pPlugin(pInitPlugin)
+	{
+	}
+
+public:
+	void OnEntityCreated(CEntityInstance *pEntity, const CEntityKeyValues *pKeyValues) override
+	{
+		if(m_pPlugin->CLogger::IsChannelEnabled(LV_DETAILED))
+		{
+			m_pPlugin->CLogger::MessageFormat("Setting up \"%s\" menu entity\n", pEntity->GetClassname());
+		}
+
+		m_pPlugin->SettingMenuEntity(instance_upper_cast<CBaseEntity *>(pEntity));
+	}
+
+private:
+	MenuSystem_Plugin *m_pPlugin;
+};
+
 void MenuSystem_Plugin::SpawnMenu(CMenu *pInternalMenu, CPlayerSlot aInitiatorSlot, const Vector &vecBackgroundOrigin, const Vector &vecOrigin, const QAngle &angRotation)
 {
+	// Reuse hidden entities of the same profile, the text is set by the display.
+	{
+		CUtlVector<CEntityInstance *> vecPooledEntities;
+
+		if(TakePooledMenuEntities(pInternalMenu->GetProfile(), vecPooledEntities))
+		{
+			auto &aBaseEntity = GetGameDataStorage().GetBaseEntity();
+
+			variant_t aEmptyVariant {};
+
+			FOR_EACH_VEC(vecPooledEntities, i)
+			{
+				auto *pEntity = vecPooledEntities[i];
+
+				aBaseEntity.Teleport(pEntity, i == MENU_ENTITY_BACKGROUND_INDEX ? vecBackgroundOrigin : vecOrigin, angRotation);
+				aBaseEntity.AcceptInput(pEntity, "Enable", NULL, NULL, &aEmptyVariant, 0);
+			}
+
+			m_aMenuEntityPoolStats.m_nReused++;
+
+			if(m_bSpawnBatching)
+			{
+				auto &aBatched = m_vecSpawnBatch[m_vecSpawnBatch.AddToTail()];
+
+				aBatched.m_pInternalMenu = pInternalMenu;
+				aBatched.m_iFirstKeyValues = -1;
+				aBatched.m_nEntities = MIN(vecPooledEntities.Count(), MENU_MAX_ENTITIES);
+				V_memcpy(aBatched.m_arrEntities, vecPooledEntities.Base(), aBatched.m_nEntities * sizeof(CEntityInstance *));
+
+				return;
+			}
+
+			pInternalMenu->Emit(vecPooledEntities);
+
+			return;
+		}
+	}
+
+	m_aMenuEntityPoolStats.m_nSpawned++;
+
 	auto *pEntitySystemAllocator = g_pEntitySystem->GetEntityKeyValuesAllocator();
 
 	const SpawnGroupHandle_t hSpawnGroup = m_pMySpawnGroupInstance->GetSpawnGroupHandle();
@@ -2016,45 +2751,90 @@ void MenuSystem_Plugin::SpawnMenu(CMenu *pInternalMenu, CPlayerSlot aInitiatorSl
 
 	CUtlVector<CEntityKeyValues *> vecMenuKVs = pInternalMenu->GenerateKeyValues(aInitiatorSlot, pEntitySystemAllocator, true);
 
+	// The spawned layers of the profile, the background is the first.
+	FOR_EACH_VEC(vecMenuKVs, i)
 	{
-		SetMenuKeyValues(vecMenuKVs[MENU_ENTITY_BACKGROUND_INDEX], vecBackgroundOrigin, angRotation);
-		SetMenuKeyValues(vecMenuKVs[MENU_ENTITY_INACTIVE_INDEX], vecOrigin, angRotation);
-		SetMenuKeyValues(vecMenuKVs[MENU_ENTITY_ACTIVE_INDEX], vecOrigin, angRotation);
-		SetMenuKeyValues(vecMenuKVs[MENU_ENTITY_DISABLED_ACTIVE_INDEX], vecOrigin, angRotation);
+		SetMenuKeyValues(vecMenuKVs[i], i == MENU_ENTITY_BACKGROUND_INDEX ? vecBackgroundOrigin : vecOrigin, angRotation);
 	}
 
-	class CMenuEntityListener : public IEntityManager::IProviderAgent::IEntityListener
+	// Spawned by EndSpawnBatch().
+	if(m_bSpawnBatching)
 	{
-	public:
-		CMenuEntityListener(MenuSystem_Plugin *pInitPlugin)
-		 :  m_pPlugin(pInitPlugin)
-		{
-		}
+		auto &aBatched = m_vecSpawnBatch[m_vecSpawnBatch.AddToTail()];
 
-	public:
-		void OnEntityCreated(CEntityInstance *pEntity, const CEntityKeyValues *pKeyValues) override
-		{
-			if(m_pPlugin->CLogger::IsChannelEnabled(LV_DETAILED))
-			{
-				m_pPlugin->CLogger::MessageFormat("Setting up \"%s\" menu entity\n", pEntity->GetClassname());
-			}
+		aBatched.m_pInternalMenu = pInternalMenu;
+		aBatched.m_iFirstKeyValues = m_vecSpawnBatchKeyValues.Count();
+		aBatched.m_nEntities = vecMenuKVs.Count();
+		m_vecSpawnBatchKeyValues.AddMultipleToTail(vecMenuKVs.Count(), vecMenuKVs.Base());
 
-			m_pPlugin->SettingMenuEntity(instance_upper_cast<CBaseEntity *>(pEntity));
-		}
+		return;
+	}
 
-	private:
-		MenuSystem_Plugin *m_pPlugin;
-	} aMenuEntitySetup(this);
+	CMenuEntityListener aMenuEntitySetup(this);
 
 	CUtlVector<CEntityInstance *> vecEntities;
 
 	SpawnEntities(vecMenuKVs, &vecEntities, &aMenuEntitySetup);
-	Assert(vecEntities.Count() == MENU_MAX_ENTITIES);
+	Assert(vecEntities.Count() == vecMenuKVs.Count());
 	pInternalMenu->Emit(vecEntities);
 
 	vecMenuKVs.PurgeAndDeleteElements();
 }
 
+void MenuSystem_Plugin::BeginSpawnBatch()
+{
+	Assert(!m_bSpawnBatching);
+	m_bSpawnBatching = true;
+	m_vecSpawnBatch.RemoveAll();
+}
+
+int MenuSystem_Plugin::EndSpawnBatch()
+{
+	Assert(m_bSpawnBatching);
+	m_bSpawnBatching = false;
+
+	auto &vecKeyValues = m_vecSpawnBatchKeyValues;
+
+	if(!vecKeyValues.Count())
+	{
+		return 0;
+	}
+
+	CMenuEntityListener aMenuEntitySetup(this);
+
+	CUtlVector<CEntityInstance *> vecEntities;
+
+	SpawnEntities(vecKeyValues, &vecEntities, &aMenuEntitySetup);
+	Assert(vecEntities.Count() == vecKeyValues.Count());
+
+	int nSpawned = 0;
+
+	// The entities follow the keyvalues order, a layer count by a menu.
+	for(auto &aBatched : m_vecSpawnBatch)
+	{
+		if(aBatched.m_iFirstKeyValues < 0)
+		{
+			continue;
+		}
+
+		for(int i = 0; i < aBatched.m_nEntities; i++)
+		{
+			int iEntity = aBatched.m_iFirstKeyValues + i;
+
+			aBatched.m_arrEntities[i] = iEntity < vecEntities.Count() ? vecEntities[iEntity] : nullptr;
+		}
+
+		nSpawned++;
+	}
+
+	vecKeyValues.PurgeAndDeleteElements();
+
+	m_aMenuEntityPoolStats.m_nBatchFlushes++;
+	m_aMenuEntityPoolStats.m_nBatchedSets += nSpawned;
+
+	return nSpawned;
+}
+
 void MenuSystem_Plugin::SpawnMenuByEntityPosition(int iMenu, CMenu *pInternalMenu, CPlayerSlot aInitiatorSlot, CBaseEntity *pTarget)
 {
 	Vector vecMenuAbsOriginBackground {},
@@ -2953,6 +3733,8 @@ void MenuSystem_Plugin::OnReloadProfilesCommand(const CCommandContext &context,
 {
 	char error[256];
 
+	PurgeMenuEntityPool(); // Pooled entities were spawned with the old profile values.
+
 	if(!LoadProfiles(error, sizeof(error)))
 	{
 		CLogger::WarningFormat("%s\n", error);
@@ -2969,6 +3751,14 @@ void MenuSystem_Plugin::OnReloadTranslationsCommand(const CCommandContext &conte
 	}
 }
 
+void MenuSystem_Plugin::OnStatsCommand(const CCommandContext &context, const CCommand &args)
+{
+	CBufferStringN<1024> sMessage;
+
+	DumpMenuStats(sMessage);
+	CLogger::Message(sMessage);
+}
+
 void MenuSystem_Plugin::OnMenuSelectCommand(const CCommandContext &context, const CCommand &args)
 {
 	int iSelectItem = args.ArgC() > 1 ? V_atoi(args.Arg(1)) : -1;
@@ -3677,6 +4467,19 @@ void MenuSystem_Plugin::OnCheckTransmit(ISource2GameEntities *pGameEntities, CCh
 				}
 			}
 		}
+
+		// Pooled entities are hidden from everyone.
+		if(m_nPooledMenuEntities)
+		{
+			uint32 *pTransmitWords = pInfo->m_pTransmitEntity->Base();
+
+			const uint32 *pPooledWords = m_bvPooledMenuEntities.Base();
+
+			for(int j = 0, nWords = m_bvPooledMenuEntities.GetNumDWords(); j < nWords; j++)
+			{
+				pTransmitWords[j] &= ~pPooledWords[j];
+			}
+		}
 	}
 }
 
@@ -0,0 +1,79 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Metamod:Source Menu System
+ * Written by Wend4r & komashchenko (Vladimir Ezhikov & Borys Komashchenko).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <menutemplate.hpp>
+
+#include <tier0/dbg.h>
+
+CMenuTemplate::CMenuTemplate(CMenuData_t::ControlItems_t *pControls)
+ :  m_aData(pControls), 
+    m_bSealed(false), 
+    m_nRefCount(1)
+{
+}
+
+bool CMenuTemplate::SetTitle(const char *pszNewText)
+{
+	if(m_bSealed)
+	{
+		return false;
+	}
+
+	m_aData.m_title.Set(pszNewText);
+
+	return true;
+}
+
+IMenu::ItemPosition_t CMenuTemplate::AddItem(const IMenu::Item_t &aItem)
+{
+	if(m_bSealed)
+	{
+		return -1;
+	}
+
+	return m_aData.m_vecItems.AddToTail(aItem);
+}
+
+bool CMenuTemplate::SetItemControls(IMenu::ItemControlFlags_t eNewControls)
+{
+	if(m_bSealed)
+	{
+		return false;
+	}
+
+	m_aData.m_eControlFlags = eNewControls;
+
+	return true;
+}
+
+int CMenuTemplate::Release()
+{
+	Assert(m_nRefCount > 0);
+
+	int nRefCount = --m_nRefCount;
+
+	if(!nRefCount)
+	{
+		delete this;
+	}
+
+	return nRefCount;
+}
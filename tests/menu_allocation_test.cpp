@@ -0,0 +1,192 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Metamod:Source Menu System
+ * Written by Wend4r & komashchenko (Vladimir Ezhikov & Borys Komashchenko).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "menu_tests.hpp"
+
+#include <menu.hpp>
+
+#include <cstddef>
+
+#include <tier0/strtools.h>
+#include <tier1/utlstring.h>
+
+#if defined(__linux__) && defined(__GLIBC__)
+#	define MENU_TEST_COUNT_ALLOCATIONS
+#endif
+
+#ifdef MENU_TEST_COUNT_ALLOCATIONS
+static bool s_bCountAllocations = false;
+static int s_nAllocations = 0;
+
+extern "C"
+{
+	void *__libc_malloc(std::size_t nSize);
+	void *__libc_calloc(std::size_t nCount, std::size_t nSize);
+	void *__libc_realloc(void *pMem, std::size_t nSize);
+
+	// Interposes the ones of the libraries, tier0 included.
+	void *malloc(std::size_t nSize)
+	{
+		s_nAllocations += s_bCountAllocations;
+
+		return __libc_malloc(nSize);
+	}
+
+	void *calloc(std::size_t nCount, std::size_t nSize)
+	{
+		s_nAllocations += s_bCountAllocations;
+
+		return __libc_calloc(nCount, nSize);
+	}
+
+	void *realloc(void *pMem, std::size_t nSize)
+	{
+		s_nAllocations += s_bCountAllocations;
+
+		return __libc_realloc(pMem, nSize);
+	}
+}
+
+// Displays the title and items as they are, checking that the views still reference them.
+class CUntouchedViewHandler : public IMenuHandler
+{
+public:
+	void OnMenuDisplayItemView(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iItem, IMenu::ItemView_t &aView) override
+	{
+		m_bCopied |= aView.Get() != aView.GetOriginal().Get();
+	}
+
+	void OnMenuDrawTitleView(IMenu *pMenu, CPlayerSlot aSlot, IMenu::TitleView_t &aView) override
+	{
+		m_bCopied |= aView.Get() != aView.GetOriginal().Get();
+	}
+
+	bool IsCopied() const
+	{
+		return m_bCopied;
+	}
+
+private:
+	bool m_bCopied = false;
+};
+
+template<class PAGE>
+static int CountRenderAllocations(CMenu &aMenu, CMenu::CPageArena &aArena)
+{
+	auto &aData = aMenu.GetData();
+
+	CMenu::CPageIndex aPageIndex;
+
+	aPageIndex.Build(aData.m_vecItems, CMenu::sm_nMaxItemsPerPage - 3);
+
+	const auto aBounds = aPageIndex.GetBounds(0);
+
+	PAGE aPage;
+
+	aArena.Reset(); // Keeps the blocks of the warm-up.
+
+	s_nAllocations = 0;
+	s_bCountAllocations = true;
+	aPage.Render(&aMenu, aData, CPlayerSlot(0), aBounds, aArena);
+	s_bCountAllocations = false;
+
+	return s_nAllocations;
+}
+
+static void FillMenu(CMenu &aMenu, int nItems)
+{
+	auto &aData = aMenu.GetData();
+
+	aData.m_title.Set("Title");
+
+	for(int i = 0; i < nItems; i++)
+	{
+		char szContent[16];
+
+		V_snprintf(szContent, sizeof(szContent), "Item %d", i);
+		aData.m_vecItems.AddToTail({i % 2 ? IMenu::MENU_ITEM_DEFAULT : IMenu::MENU_ITEM_HASNUMBER, szContent});
+	}
+}
+
+// The untouched title and items must render without heap allocations, once the arena and the render scratch are warm.
+bool MenuTest_RenderAllocations()
+{
+	{
+		s_nAllocations = 0;
+		s_bCountAllocations = true;
+
+		CUtlString sProbe("A string to see the allocator");
+
+		s_bCountAllocations = false;
+
+		if(!s_nAllocations)
+		{
+			std::printf("Skipped, the tier0 allocator does not reach malloc()\n");
+
+			return true;
+		}
+	}
+
+	CUntouchedViewHandler aHandler;
+
+	IMenuHandler *const arrHandlers[] = {nullptr, &aHandler};
+
+	for(auto *pHandler : arrHandlers)
+	{
+		IMenu::Item_t arrControlItems[] = {{IMenu::MENU_ITEM_FULL, "Back"}, {IMenu::MENU_ITEM_FULL, "Next"}, {IMenu::MENU_ITEM_FULL, "Exit"}};
+
+		CMenuData_t::ControlItems_t aControls {&arrControlItems[0], &arrControlItems[1], &arrControlItems[2]};
+
+		CMenu aOneItemMenu(nullptr, nullptr, nullptr, nullptr, pHandler, &aControls),
+		      aFullMenu(nullptr, nullptr, nullptr, nullptr, pHandler, &aControls);
+
+		FillMenu(aOneItemMenu, 1);
+		FillMenu(aFullMenu, CMenu::sm_nMaxItemsPerPage - 3);
+
+		CMenu::CPageArena aArena;
+
+		// Warm up the arena blocks and the render scratch.
+		CountRenderAllocations<CMenu::CPage>(aFullMenu, aArena);
+		CountRenderAllocations<CMenu::CPageBase>(aFullMenu, aArena);
+
+		const int nOneItemAllocations = CountRenderAllocations<CMenu::CPage>(aOneItemMenu, aArena),
+		          nFullAllocations = CountRenderAllocations<CMenu::CPage>(aFullMenu, aArena);
+
+		std::printf("%s handler: %d allocations of a page with 1 item, %d with %d items\n", pHandler ? "A view" : "No", nOneItemAllocations, nFullAllocations, CMenu::sm_nMaxItemsPerPage - 3);
+
+		MENU_TEST_CHECK(!nOneItemAllocations);
+		MENU_TEST_CHECK(!nFullAllocations);
+		MENU_TEST_CHECK(!CountRenderAllocations<CMenu::CPageBase>(aOneItemMenu, aArena));
+		MENU_TEST_CHECK(!CountRenderAllocations<CMenu::CPageBase>(aFullMenu, aArena));
+	}
+
+	MENU_TEST_CHECK(!aHandler.IsCopied());
+
+	return true;
+}
+#else
+bool MenuTest_RenderAllocations()
+{
+	std::printf("Skipped, the allocations are counted with glibc only\n");
+
+	return true;
+}
+#endif // MENU_TEST_COUNT_ALLOCATIONS
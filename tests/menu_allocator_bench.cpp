@@ -0,0 +1,132 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Metamod:Source Menu System
+ * Written by Wend4r & komashchenko (Vladimir Ezhikov & Borys Komashchenko).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <menuallocator.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include <tier1/utlvector.h>
+
+using CBenchMenuAllocator = CMenuAllocator<>;
+
+// The block scan FindMemBlock() did before the block header, over the same instances.
+static CMenu *FindByScan(const CUtlVector<CMenu *> &vecMenus, IMenu *pMenu)
+{
+	FOR_EACH_VEC_BACK(vecMenus, i)
+	{
+		CMenu *pElm = vecMenus[i];
+
+		if(static_cast<IMenu *>(pElm) == pMenu)
+		{
+			return pElm;
+		}
+	}
+
+	return nullptr;
+}
+
+template<class FUNC>
+static double MeasureLookupNanoseconds(int nLookups, FUNC funcLookup)
+{
+	const auto aStart = std::chrono::steady_clock::now();
+
+	for(int i = 0; i < nLookups; i++)
+	{
+		funcLookup(i);
+	}
+
+	const std::chrono::duration<double, std::nano> aElapsed = std::chrono::steady_clock::now() - aStart;
+
+	return aElapsed.count() / nLookups;
+}
+
+// Times the lookups of live menus by pointer and by handle, against the scan.
+int main(int argc, char *argv[])
+{
+	const int nLookups = argc > 1 ? std::atoi(argv[1]) : 1000000;
+
+	if(nLookups <= 0)
+	{
+		std::fprintf(stderr, "Usage: %s [lookups]\n", argv[0]);
+
+		return 1;
+	}
+
+	static const int s_arrLiveCounts[] = {16, 256, 4096};
+
+	uintp nFound = 0; // Keeps the lookups.
+
+	std::printf("%-6s %14s %14s %14s %14s\n", "Live", "Pointer ns", "Handle ns", "Upcast ns", "Scan ns");
+
+	for(int nLive : s_arrLiveCounts)
+	{
+		CBenchMenuAllocator aAllocator;
+
+		CUtlVector<CMenu *> vecMenus;
+
+		CUtlVector<IMenu::Handle_t> vecHandles;
+
+		for(int i = 0; i < nLive; i++)
+		{
+			CMenu *pMenu = aAllocator.CreateInstance(nullptr, nullptr, nullptr, nullptr);
+
+			vecMenus.AddToTail(pMenu);
+			vecHandles.AddToTail(aAllocator.FindHandle(pMenu));
+		}
+
+		// Visits the menus out of order, as the closes and the timeouts do.
+		auto GetLookupIndex = [nLive](int i)
+		{
+			return static_cast<int>((static_cast<uint64>(i) * 7919) % nLive);
+		};
+
+		const double flPointerNs = MeasureLookupNanoseconds(nLookups, [&](int i)
+		{
+			nFound += !!aAllocator.FindMemBlock(vecMenus[GetLookupIndex(i)]);
+		});
+
+		const double flHandleNs = MeasureLookupNanoseconds(nLookups, [&](int i)
+		{
+			nFound += !!aAllocator.FindByHandle(vecHandles[GetLookupIndex(i)]);
+		});
+
+		const double flUpcastNs = MeasureLookupNanoseconds(nLookups, [&](int i)
+		{
+			nFound += !!aAllocator.FindAndUpperCast(vecMenus[GetLookupIndex(i)]);
+		});
+
+		const double flScanNs = MeasureLookupNanoseconds(nLookups, [&](int i)
+		{
+			nFound += !!FindByScan(vecMenus, vecMenus[GetLookupIndex(i)]);
+		});
+
+		std::printf("%-6d %14.2f %14.2f %14.2f %14.2f\n", nLive, flPointerNs, flHandleNs, flUpcastNs, flScanNs);
+
+		aAllocator.ReleaseAll();
+		aAllocator.PurgeAndDeleteElements();
+	}
+
+	std::printf("%d lookups per case, %llu found\n", nLookups, static_cast<unsigned long long>(nFound));
+
+	return 0;
+}
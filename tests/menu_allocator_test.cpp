@@ -0,0 +1,189 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Metamod:Source Menu System
+ * Written by Wend4r & komashchenko (Vladimir Ezhikov & Borys Komashchenko).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "menu_tests.hpp"
+
+#include <menuallocator.hpp>
+
+#include <new>
+
+using CTestMenuAllocator = CMenuAllocator<>;
+
+// A menu laid out as the allocator ones, with a header of the test choice.
+struct alignas(MENU_MEMBLOCK_HEADER_ALIGN) ForgedBlock_t
+{
+	unsigned char m_arrData[CTestMenuAllocator::sm_nBlockSize];
+
+	CTestMenuAllocator::BlockHeader_t *GetHeader()
+	{
+		return reinterpret_cast<CTestMenuAllocator::BlockHeader_t *>(m_arrData);
+	}
+
+	CMenu *Construct()
+	{
+		return new(&m_arrData[CTestMenuAllocator::sm_nHeaderSize]) CMenu(nullptr, nullptr, nullptr, nullptr);
+	}
+};
+
+static CMenu *CreateMenu(CTestMenuAllocator &aAllocator)
+{
+	return aAllocator.CreateInstance(nullptr, nullptr, nullptr, nullptr);
+}
+
+// Pointers out of the allocator are rejected by the block header, and handles of released blocks stay stale.
+bool MenuTest_AllocatorLookup()
+{
+	CTestMenuAllocator aAllocator;
+
+	CMenu *pLiveMenu = CreateMenu(aAllocator);
+
+	MENU_TEST_CHECK(pLiveMenu);
+	MENU_TEST_CHECK(aAllocator.FindAndUpperCast(pLiveMenu) == pLiveMenu);
+
+	const auto hLiveMenu = aAllocator.FindHandle(pLiveMenu);
+
+	MENU_TEST_CHECK(hLiveMenu != MENU_INVALID_HANDLE);
+	MENU_TEST_CHECK(aAllocator.FindByHandle(hLiveMenu) == pLiveMenu);
+
+	// Foreign pointers.
+	{
+		MENU_TEST_CHECK(!aAllocator.FindMemBlock(nullptr));
+
+		ForgedBlock_t aForgedBlock;
+
+		CMenu *pForgedMenu = aForgedBlock.Construct();
+
+		const int arrForgedIndices[] = {aAllocator.GetMemBlockIndex(aAllocator.FindMemBlock(pLiveMenu)), MENU_MEMBLOCK_INVALID_INDEX, 1 << 20}; // A live block, and out of the blocks.
+
+		for(int iForged : arrForgedIndices)
+		{
+			aForgedBlock.GetHeader()->m_iMemBlock = iForged;
+
+			MENU_TEST_CHECK(!aAllocator.FindMemBlock(pForgedMenu));
+			MENU_TEST_CHECK(!aAllocator.FindAndUpperCast(pForgedMenu));
+			MENU_TEST_CHECK(aAllocator.FindHandle(pForgedMenu) == MENU_INVALID_HANDLE);
+			MENU_TEST_CHECK(!aAllocator.ReleaseByInterface(pForgedMenu));
+		}
+
+		pForgedMenu->~CMenu();
+
+		MENU_TEST_CHECK(aAllocator.GetStats().m_nLive == 1);
+	}
+
+	// A released one.
+	{
+		CMenu *pReleasedMenu = CreateMenu(aAllocator);
+
+		const auto hReleasedMenu = aAllocator.FindHandle(pReleasedMenu);
+
+		MENU_TEST_CHECK(aAllocator.ReleaseByInterface(pReleasedMenu));
+		MENU_TEST_CHECK(!aAllocator.FindMemBlock(pReleasedMenu));
+		MENU_TEST_CHECK(!aAllocator.FindByHandle(hReleasedMenu));
+		MENU_TEST_CHECK(!aAllocator.ReleaseByInterface(pReleasedMenu)); // Not destructed twice.
+
+		// The block is reused by a new generation.
+		CMenu *pReusedMenu = CreateMenu(aAllocator);
+
+		MENU_TEST_CHECK(pReusedMenu == pReleasedMenu);
+		MENU_TEST_CHECK(!aAllocator.FindByHandle(hReleasedMenu));
+		MENU_TEST_CHECK(aAllocator.FindHandle(pReusedMenu) != hReleasedMenu);
+		MENU_TEST_CHECK(aAllocator.ReleaseByInterface(pReusedMenu));
+	}
+
+	// A closing one.
+	{
+		CMenu *pClosingMenu = CreateMenu(aAllocator);
+
+		const auto hClosingMenu = aAllocator.FindHandle(pClosingMenu);
+
+		auto *pMemBlock = aAllocator.FindMemBlock(pClosingMenu);
+
+		pMemBlock->MarkClosing();
+
+		MENU_TEST_CHECK(!aAllocator.FindMemBlock(pClosingMenu));
+		MENU_TEST_CHECK(aAllocator.FindMemBlock(pClosingMenu, true) == pMemBlock);
+		MENU_TEST_CHECK(!aAllocator.FindByHandle(hClosingMenu));
+
+		aAllocator.ReleaseByMemBlock(pMemBlock);
+	}
+
+	// Compact() with live menus keeps the blocks.
+	{
+		CMenu *pReleasedMenu = CreateMenu(aAllocator);
+
+		const auto hReleasedMenu = aAllocator.FindHandle(pReleasedMenu);
+
+		MENU_TEST_CHECK(aAllocator.ReleaseByInterface(pReleasedMenu));
+		MENU_TEST_CHECK(!aAllocator.Compact());
+		MENU_TEST_CHECK(!aAllocator.FindByHandle(hReleasedMenu));
+		MENU_TEST_CHECK(aAllocator.FindByHandle(hLiveMenu) == pLiveMenu);
+
+		CMenu *pReusedMenu = CreateMenu(aAllocator);
+
+		MENU_TEST_CHECK(!aAllocator.FindByHandle(hReleasedMenu));
+		MENU_TEST_CHECK(aAllocator.ReleaseByInterface(pReusedMenu));
+	}
+
+	// Compact() with live menus destructs the warm ones past the last live block.
+	{
+		aAllocator.SetWarmLimit(2);
+
+		CMenu *pWarmMenus[] = {CreateMenu(aAllocator), CreateMenu(aAllocator)};
+
+		for(CMenu *pWarmMenu : pWarmMenus)
+		{
+			MENU_TEST_CHECK(aAllocator.ReleaseByInterface(pWarmMenu));
+		}
+
+		MENU_TEST_CHECK(aAllocator.GetStats().m_nWarm == 2);
+		MENU_TEST_CHECK(!aAllocator.Compact());
+		MENU_TEST_CHECK(aAllocator.GetStats().m_nWarm == 0);
+		MENU_TEST_CHECK(aAllocator.FindByHandle(hLiveMenu) == pLiveMenu);
+
+		aAllocator.SetWarmLimit(0);
+
+		CMenu *pReusedMenu = CreateMenu(aAllocator);
+
+		MENU_TEST_CHECK(pReusedMenu);
+		MENU_TEST_CHECK(aAllocator.ReleaseByInterface(pReusedMenu));
+	}
+
+	// Compact() without live menus purges the blocks, the new ones must not take the old generations.
+	{
+		MENU_TEST_CHECK(aAllocator.ReleaseByInterface(pLiveMenu));
+		MENU_TEST_CHECK(aAllocator.Compact());
+		MENU_TEST_CHECK(!aAllocator.FindByHandle(hLiveMenu));
+
+		for(int i = 0; i < 4; i++)
+		{
+			CMenu *pNewMenu = CreateMenu(aAllocator);
+
+			MENU_TEST_CHECK(pNewMenu);
+			MENU_TEST_CHECK(!aAllocator.FindByHandle(hLiveMenu));
+			MENU_TEST_CHECK(aAllocator.FindHandle(pNewMenu) != hLiveMenu);
+		}
+
+		aAllocator.ReleaseAll();
+		aAllocator.PurgeAndDeleteElements();
+	}
+
+	return true;
+}
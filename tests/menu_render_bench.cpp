@@ -0,0 +1,341 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Metamod:Source Menu System
+ * Written by Wend4r & komashchenko (Vladimir Ezhikov & Borys Komashchenko).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <menu.hpp>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+#include <tier0/strtools.h>
+
+// The texts of the generic render, as CPage stores them.
+struct GenericPage_t
+{
+	const char *m_pszText = "";
+	const char *m_pszInactiveText = "";
+	const char *m_pszActiveText = "";
+	const char *m_pszDisabledActiveText = "";
+	int m_nTextBytes = 0;
+};
+
+// CPage render before RenderAs(): the control flags and the handler are checked at runtime.
+static void GenericRender(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, const CMenu::PageBounds_t &aBounds, CMenu::CPageArena &aArena, GenericPage_t &aPage)
+{
+	using CLayerWriter = CMenu::CLayerWriter;
+
+	static CMenu::CBufferStringText s_aText(MENU_MAX_TEXT_LENGTH),
+	                                s_aInactiveText(MENU_MAX_TEXT_LENGTH),
+	                                s_aActiveText(MENU_MAX_TEXT_LENGTH),
+	                                s_aDisabledActiveText(MENU_MAX_TEXT_LENGTH);
+
+	static CMenu::CBufferStringText *const s_arrLayers[MENU_MAX_ENTITIES] = {&s_aText, &s_aInactiveText, &s_aActiveText, &s_aDisabledActiveText};
+
+	for(auto *pLayer : s_arrLayers)
+	{
+		pLayer->Clear();
+	}
+
+	auto *const *ppLayers = s_arrLayers;
+
+	CLayerWriter aWriter(ppLayers, MENU_MAX_ENTITIES, MENU_MAX_TEXT_LENGTH);
+
+	IMenuHandler *pHandler = pMenu->GetHandler();
+
+	// Append a title.
+	{
+		auto aTitle = aData.m_title;
+
+		if(pHandler)
+		{
+			pHandler->OnMenuDrawTitle(pMenu, aSlot, aTitle);
+		}
+
+		const auto &aTitleText = aTitle.m_sText;
+
+		if(!aTitleText.IsEmpty())
+		{
+			aWriter.AppendLine(CLayerWriter::MENU_LAYER_ALL & ~CLayerWriter::MENU_LAYER_ACTIVE, nullptr, aTitleText.Get(), aTitleText.Length());
+			aWriter.AppendEnds();
+		}
+	}
+
+	// Append items.
+	{
+		const auto &vecItems = aBounds.m_pItems ? *aBounds.m_pItems : aData.m_vecItems;
+
+		const IMenu::ItemPosition_t iItemsBase = aBounds.m_pItems ? aBounds.m_iStartItem : MENU_FIRST_ITEM_INDEX;
+
+		const auto eControlFlags = aData.m_eControlFlags;
+
+		const bool bHasBackButton = !!(eControlFlags & IMenu::MENU_ITEM_CONTROL_FLAG_BACK),
+		           bHasNextButton = !!(eControlFlags & IMenu::MENU_ITEM_CONTROL_FLAG_NEXT),
+		           bHasExitButton = !!(eControlFlags & IMenu::MENU_ITEM_CONTROL_FLAG_EXIT);
+
+		const uint8 nControlsSum = bHasBackButton + bHasNextButton + bHasExitButton;
+
+		const bool bItemsOverflow = aBounds.m_bHasNext,
+		           bItemsHasLeft = aBounds.m_bHasBack;
+
+		char szItemNumber[2] = "";
+
+		int nShownItems = 0;
+
+		for(IMenu::ItemPosition_t i = aBounds.m_iStartItem; i < aBounds.m_iEndItem; i++)
+		{
+			const auto &aItem = vecItems[i - iItemsBase];
+
+			if(aItem.IsEmpty())
+			{
+				continue;
+			}
+
+			nShownItems++;
+
+			IMenu::ItemView_t aItemView(aItem);
+
+			if(pHandler)
+			{
+				pHandler->OnMenuDisplayItemView(pMenu, aSlot, i, aItemView);
+			}
+
+			if(aItemView.IsEmpty())
+			{
+				continue;
+			}
+
+			auto eItemStyle = aItemView.GetStyle();
+
+			const char *pszItemContent = aItemView.Get();
+
+			const char *pszItemNumber = nullptr;
+
+			if(eItemStyle & IMenu::MENU_ITEM_HASNUMBER)
+			{
+				szItemNumber[0] = '0' + nShownItems % 10;
+				pszItemNumber = szItemNumber;
+			}
+
+			CLayerWriter::LayerMask_t nLineLayers = CLayerWriter::MENU_LAYER_TEXT | ((eItemStyle & IMenu::MENU_ITEM_ACTIVE) ? CLayerWriter::MENU_LAYER_ACTIVE : (CLayerWriter::MENU_LAYER_INACTIVE | CLayerWriter::MENU_LAYER_DISABLED_ACTIVE));
+
+			aWriter.AppendLine(nLineLayers, pszItemNumber, pszItemContent);
+		}
+
+		// Append control items.
+		auto *pControlItems = aData.m_pControlItems;
+
+		if(nControlsSum && pControlItems)
+		{
+			aWriter.AppendEnds();
+
+			auto aControlItems = *pControlItems;
+
+			for(const auto &it : aControlItems)
+			{
+				auto i = &it - aControlItems.cbegin();
+
+				auto eControlItem = static_cast<IMenu::ItemControls_t>(-static_cast<IMenu::ItemPosition_t>(i + 1));
+
+				bool bSkipControlItem = (eControlItem == IMenu::MENU_ITEM_CONTROL_BACK_INDEX && (!bHasBackButton || !bItemsHasLeft)) ||
+				                        (eControlItem == IMenu::MENU_ITEM_CONTROL_NEXT_INDEX && (!bHasNextButton || !bItemsOverflow)) ||
+				                        (eControlItem == IMenu::MENU_ITEM_CONTROL_EXIT_INDEX && (!bHasExitButton));
+
+				IMenu::ItemView_t aItemView(it);
+
+				if(pHandler)
+				{
+					pHandler->OnMenuDisplayItemView(pMenu, aSlot, eControlItem, aItemView);
+				}
+
+				if(aItemView.IsEmpty())
+				{
+					continue;
+				}
+
+				auto eItemStyle = aItemView.GetStyle();
+
+				const char *pszItemContent = aItemView.Get();
+
+				CLayerWriter::LayerMask_t nLineLayers;
+
+				if(eItemStyle & IMenu::MENU_ITEM_HASNUMBER)
+				{
+					if(!bSkipControlItem)
+					{
+						szItemNumber[0] = '8' + i;
+
+						if(szItemNumber[0] >= ':')
+						{
+							szItemNumber[0] -= 10;
+						}
+					}
+
+					if(eItemStyle & IMenu::MENU_ITEM_ACTIVE)
+					{
+						nLineLayers = bSkipControlItem ? 0 : (CLayerWriter::MENU_LAYER_TEXT | CLayerWriter::MENU_LAYER_ACTIVE);
+					}
+					else
+					{
+						nLineLayers = (bSkipControlItem ? CLayerWriter::MENU_LAYER_INACTIVE : CLayerWriter::MENU_LAYER_TEXT) | CLayerWriter::MENU_LAYER_DISABLED_ACTIVE;
+					}
+
+					aWriter.AppendLine(nLineLayers, szItemNumber, pszItemContent);
+				}
+				else
+				{
+					if(eItemStyle & IMenu::MENU_ITEM_ACTIVE)
+					{
+						nLineLayers = CLayerWriter::MENU_LAYER_TEXT | (bSkipControlItem ? 0 : CLayerWriter::MENU_LAYER_ACTIVE);
+					}
+					else
+					{
+						nLineLayers = CLayerWriter::MENU_LAYER_TEXT | (bSkipControlItem ? 0 : CLayerWriter::MENU_LAYER_INACTIVE) | CLayerWriter::MENU_LAYER_DISABLED_ACTIVE;
+					}
+
+					aWriter.AppendLine(nLineLayers, nullptr, pszItemContent);
+				}
+			}
+		}
+	}
+
+	auto Store = [&](MenuEntity_t eEntity)
+	{
+		const auto *pLayer = ppLayers[eEntity];
+
+		const int nLength = pLayer->Length();
+
+		aPage.m_nTextBytes += nLength + 1;
+
+		return aArena.Store(pLayer->Get(), nLength);
+	};
+
+	aPage.m_nTextBytes = 0;
+	aPage.m_pszText = Store(MENU_ENTITY_BACKGROUND_INDEX);
+	aPage.m_pszInactiveText = Store(MENU_ENTITY_INACTIVE_INDEX);
+	aPage.m_pszActiveText = Store(MENU_ENTITY_ACTIVE_INDEX);
+	aPage.m_pszDisabledActiveText = Store(MENU_ENTITY_DISABLED_ACTIVE_INDEX);
+}
+
+// Leaves the title and items untouched, so the handler costs its calls only.
+class CBenchHandler : public IMenuHandler
+{
+public:
+	OverrideFlags_t GetMenuOverrides() const override
+	{
+		return MENU_HANDLER_OVERRIDES_NONE;
+	}
+};
+
+template<class FUNC>
+static double MeasurePageNanoseconds(int nIterations, FUNC funcRender)
+{
+	const auto aStart = std::chrono::steady_clock::now();
+
+	for(int i = 0; i < nIterations; i++)
+	{
+		funcRender();
+	}
+
+	const std::chrono::duration<double, std::nano> aElapsed = std::chrono::steady_clock::now() - aStart;
+
+	return aElapsed.count() / nIterations;
+}
+
+// Times the middle page of a menu for every render variant, against the generic render.
+int main(int argc, char *argv[])
+{
+	const int nIterations = argc > 1 ? std::atoi(argv[1]) : 200000;
+
+	if(nIterations <= 0)
+	{
+		std::fprintf(stderr, "Usage: %s [iterations]\n", argv[0]);
+
+		return 1;
+	}
+
+	CBenchHandler aHandler;
+
+	const CPlayerSlot aSlot(0);
+
+	int nTextBytes = 0; // Keeps the renders.
+
+	std::printf("%-8s %-7s %12s %12s %8s\n", "Controls", "Handler", "RenderAs ns", "Generic ns", "Ratio");
+
+	for(int iVariant = 0; iVariant < CMenu::CPageBase::sm_nRenderVariants; iVariant++)
+	{
+		const auto eControlFlags = static_cast<IMenu::ItemControlFlags_t>(iVariant & IMenu::MENU_ITEM_CONTROL_DEFAULT_FLAGS);
+
+		const bool bHasHandler = !!(iVariant & CMenu::CPageBase::sm_nRenderHandlerBit);
+
+		IMenu::Item_t arrControlItems[] = {{IMenu::MENU_ITEM_DEFAULT, "Back"}, {IMenu::MENU_ITEM_DEFAULT, "Next"}, {IMenu::MENU_ITEM_DEFAULT, "Exit"}};
+
+		CMenuData_t::ControlItems_t aControls {&arrControlItems[0], &arrControlItems[1], &arrControlItems[2]};
+
+		CMenu aMenu(nullptr, nullptr, nullptr, nullptr, bHasHandler ? &aHandler : nullptr, &aControls);
+
+		auto &aData = aMenu.GetData();
+
+		const uint8 nMaxItems = CMenu::sm_nMaxItemsPerPage - (!!(eControlFlags & IMenu::MENU_ITEM_CONTROL_FLAG_BACK) + !!(eControlFlags & IMenu::MENU_ITEM_CONTROL_FLAG_NEXT) + !!(eControlFlags & IMenu::MENU_ITEM_CONTROL_FLAG_EXIT));
+
+		aData.m_title.Set("Benchmark");
+		aData.m_eControlFlags = eControlFlags;
+
+		for(int i = 0; i < 3 * nMaxItems; i++)
+		{
+			char szContent[32];
+
+			V_snprintf(szContent, sizeof(szContent), "Benchmark item %d", i);
+			aData.m_vecItems.AddToTail({i % 3 ? IMenu::MENU_ITEM_DEFAULT : IMenu::MENU_ITEM_HASNUMBER, szContent});
+		}
+
+		CMenu::CPageIndex aPageIndex;
+
+		aPageIndex.Build(aData.m_vecItems, nMaxItems);
+
+		const auto aBounds = aPageIndex.GetBounds(1); // Has the back and the next pages.
+
+		CMenu::CPageArena aArena;
+
+		CMenu::CPage aPage;
+
+		GenericPage_t aGenericPage;
+
+		const double flRenderAsNs = MeasurePageNanoseconds(nIterations, [&]()
+		{
+			aArena.Reset();
+			aPage.Render(&aMenu, aData, aSlot, aBounds, aArena);
+			nTextBytes += aPage.GetTextBytes();
+		});
+
+		const double flGenericNs = MeasurePageNanoseconds(nIterations, [&]()
+		{
+			aArena.Reset();
+			GenericRender(&aMenu, aData, aSlot, aBounds, aArena, aGenericPage);
+			nTextBytes += aGenericPage.m_nTextBytes;
+		});
+
+		std::printf("%-8d %-7s %12.1f %12.1f %8.3f\n", static_cast<int>(eControlFlags), bHasHandler ? "yes" : "no", flRenderAsNs, flGenericNs, flRenderAsNs / flGenericNs);
+	}
+
+	std::printf("%d iterations per variant, %d text bytes rendered\n", nIterations, nTextBytes);
+
+	return 0;
+}
@@ -0,0 +1,620 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Metamod:Source Menu System
+ * Written by Wend4r & komashchenko (Vladimir Ezhikov & Borys Komashchenko).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "menu_tests.hpp"
+
+#include <menu.hpp>
+
+#include <concat.hpp>
+
+#include <tier0/strtools.h>
+
+static const CConcatLineString s_aReferenceConcat = ConcatLine_t<const char *>
+{
+	"",     // Starts with.
+	"",     // Before key.
+	". ",   // Between key & value.
+	"\n",   // Ends.
+	"\n\n"  // Ends and starts with.
+};
+
+// The page layers of the reference render.
+struct ReferencePage_t
+{
+	CMenu::CBufferStringText m_sText {MENU_MAX_TEXT_LENGTH};
+	CMenu::CBufferStringText m_sInactiveText {MENU_MAX_TEXT_LENGTH};
+	CMenu::CBufferStringText m_sActiveText {MENU_MAX_TEXT_LENGTH};
+	CMenu::CBufferStringText m_sDisabledActiveText {MENU_MAX_TEXT_LENGTH};
+};
+
+// The CPageBase render by CConcatLineBuffer, before the layer writer.
+static void ReferenceRenderBase(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, IMenu::ItemPosition_t iStartPosition, uint8 nMaxItems, CMenu::CBufferStringText &sText)
+{
+	const auto &aConcat = s_aReferenceConcat;
+
+	IMenuHandler *pHandler = pMenu->GetHandler();
+
+	// Append a title.
+	{
+		auto aTitle = aData.m_title;
+
+		if(pHandler)
+		{
+			pHandler->OnMenuDrawTitle(pMenu, aSlot, aTitle);
+		}
+
+		const auto &aTitleText = aTitle.m_sText;
+
+		if(!aTitleText.IsEmpty())
+		{
+			const char *pszTitleText = aTitleText.Get();
+
+			CConcatLineBuffer(&aConcat, &sText).Append(pszTitleText);
+			CConcatLineBuffer(&aConcat, &sText).AppendEnds();
+		}
+	}
+
+	// Append items.
+	{
+		const auto &vecItems = aData.m_vecItems;
+
+		const auto eControlFlags = aData.m_eControlFlags;
+
+		const bool bHasBackButton = !!(eControlFlags & IMenu::MENU_ITEM_CONTROL_FLAG_BACK),
+		           bHasNextButton = !!(eControlFlags & IMenu::MENU_ITEM_CONTROL_FLAG_NEXT),
+		           bHasExitButton = !!(eControlFlags & IMenu::MENU_ITEM_CONTROL_FLAG_EXIT);
+
+		const uint8 nControlsSum = bHasBackButton + bHasNextButton + bHasExitButton;
+
+		int nLeftItems = vecItems.Count() - iStartPosition;
+
+		const bool bItemsOverflow = nLeftItems > nMaxItems,
+		           bItemsHasLeft = iStartPosition >= nMaxItems;
+
+		const IMenu::ItemPosition_t nItemsOnPage = bItemsOverflow ? (iStartPosition + nMaxItems) : vecItems.Count();
+
+		char szItemNumber[2] = "";
+
+		for(IMenu::ItemPosition_t i = iStartPosition; i < nItemsOnPage; i++)
+		{
+			auto aItemCopy = vecItems[i];
+
+			if(pHandler)
+			{
+				pHandler->OnMenuDisplayItem(pMenu, aSlot, i, aItemCopy);
+			}
+
+			const auto &sItemContent = aItemCopy.m_sContent;
+
+			if(sItemContent.IsEmpty())
+			{
+				continue;
+			}
+
+			auto eItemStyle = aItemCopy.m_eStyle;
+
+			const char *pszItemContent = sItemContent.Get();
+
+			if(eItemStyle & IMenu::MENU_ITEM_HASNUMBER)
+			{
+				szItemNumber[0] = '0' + (i - iStartPosition + 1) % 10; // The 10th is "0", as its key.
+				CConcatLineBuffer(&aConcat, &sText).Append(szItemNumber, pszItemContent);
+			}
+			else
+			{
+				CConcatLineBuffer(&aConcat, &sText).Append(pszItemContent);
+			}
+		}
+
+		// Append control items.
+		auto *pControlItems = aData.m_pControlItems;
+
+		if(nControlsSum && pControlItems)
+		{
+			CConcatLineBuffer(&aConcat, &sText).AppendEnds();
+
+			auto aControlItems = *pControlItems;
+
+			for(const auto &it : aControlItems)
+			{
+				auto i = &it - aControlItems.cbegin();
+
+				auto eControlItem = static_cast<IMenu::ItemControls_t>(-static_cast<IMenu::ItemPosition_t>(i + 1));
+
+				bool bSkipControlItem = (eControlItem == IMenu::MENU_ITEM_CONTROL_BACK_INDEX && (!bHasBackButton || !bItemsHasLeft)) ||
+				                        (eControlItem == IMenu::MENU_ITEM_CONTROL_NEXT_INDEX && (!bHasNextButton || !bItemsOverflow)) ||
+				                        (eControlItem == IMenu::MENU_ITEM_CONTROL_EXIT_INDEX && (!bHasExitButton));
+
+				auto aItemCopy = it;
+
+				if(pHandler)
+				{
+					pHandler->OnMenuDisplayItem(pMenu, aSlot, eControlItem, aItemCopy);
+				}
+
+				const auto &sItemContent = aItemCopy.m_sContent;
+
+				if(sItemContent.IsEmpty())
+				{
+					continue;
+				}
+
+				auto eItemStyle = aItemCopy.m_eStyle;
+
+				const char *pszItemContent = sItemContent.Get();
+
+				if(eItemStyle & IMenu::MENU_ITEM_HASNUMBER)
+				{
+					if(bSkipControlItem)
+					{
+						CConcatLineBuffer(&aConcat, &sText).AppendEnds();
+					}
+					else
+					{
+						szItemNumber[0] = '8' + i;
+
+						if(szItemNumber[0] >= ':')
+						{
+							szItemNumber[0] -= 10;
+						}
+
+						CConcatLineBuffer(&aConcat, &sText).Append(szItemNumber, pszItemContent);
+					}
+				}
+				else
+				{
+					CConcatLineBuffer(&aConcat, &sText).Append(pszItemContent);
+				}
+			}
+		}
+	}
+}
+
+// The CPage render by CConcatLineBuffer, before the layer writer.
+static void ReferenceRender(IMenu *pMenu, CMenuData_t &aData, CPlayerSlot aSlot, IMenu::ItemPosition_t iStartPosition, uint8 nMaxItems, ReferencePage_t &aPage)
+{
+	const auto &aConcat = s_aReferenceConcat;
+
+	auto &sText = aPage.m_sText,
+	     &sInactiveText = aPage.m_sInactiveText,
+	     &sActiveText = aPage.m_sActiveText,
+	     &sDisabledActiveText = aPage.m_sDisabledActiveText;
+
+	IMenuHandler *pHandler = pMenu->GetHandler();
+
+	// Append a title.
+	{
+		auto aTitle = aData.m_title;
+
+		if(pHandler)
+		{
+			pHandler->OnMenuDrawTitle(pMenu, aSlot, aTitle);
+		}
+
+		const auto &aTitleText = aTitle.m_sText;
+
+		if(!aTitleText.IsEmpty())
+		{
+			const char *pszTitleText = aTitleText.Get();
+
+			CConcatLineBuffer(&aConcat, &sText).Append(pszTitleText);
+			CConcatLineBuffer(&aConcat, &sText).AppendEnds();
+			CConcatLineBuffer(&aConcat, &sInactiveText).Append(pszTitleText);
+			CConcatLineBuffer(&aConcat, &sInactiveText).AppendEnds();
+			CConcatLineBuffer(&aConcat, &sActiveText).AppendEndsAndStartsWith();
+			CConcatLineBuffer(&aConcat, &sDisabledActiveText).Append(pszTitleText);
+			CConcatLineBuffer(&aConcat, &sDisabledActiveText).AppendEnds();
+		}
+	}
+
+	// Append items.
+	{
+		const auto &vecItems = aData.m_vecItems;
+
+		const auto eControlFlags = aData.m_eControlFlags;
+
+		const bool bHasBackButton = !!(eControlFlags & IMenu::MENU_ITEM_CONTROL_FLAG_BACK),
+		           bHasNextButton = !!(eControlFlags & IMenu::MENU_ITEM_CONTROL_FLAG_NEXT),
+		           bHasExitButton = !!(eControlFlags & IMenu::MENU_ITEM_CONTROL_FLAG_EXIT);
+
+		const uint8 nControlsSum = bHasBackButton + bHasNextButton + bHasExitButton;
+
+		int nLeftItems = vecItems.Count() - iStartPosition;
+
+		const bool bItemsOverflow = nLeftItems > nMaxItems,
+		           bItemsHasLeft = iStartPosition >= nMaxItems;
+
+		const IMenu::ItemPosition_t nItemsOnPage = bItemsOverflow ? (iStartPosition + nMaxItems) : vecItems.Count();
+
+		char szItemNumber[2] = "";
+
+		for(IMenu::ItemPosition_t i = iStartPosition; i < nItemsOnPage; i++)
+		{
+			auto aItemCopy = vecItems[i];
+
+			if(pHandler)
+			{
+				pHandler->OnMenuDisplayItem(pMenu, aSlot, i, aItemCopy);
+			}
+
+			const auto &sItemContent = aItemCopy.m_sContent;
+
+			if(sItemContent.IsEmpty())
+			{
+				continue;
+			}
+
+			auto eItemStyle = aItemCopy.m_eStyle;
+
+			const char *pszItemContent = sItemContent.Get();
+
+			if(eItemStyle & IMenu::MENU_ITEM_HASNUMBER)
+			{
+				szItemNumber[0] = '0' + (i - iStartPosition + 1) % 10; // The 10th is "0", as its key.
+				CConcatLineBuffer(&aConcat, &sText).Append(szItemNumber, pszItemContent);
+
+				if(eItemStyle & IMenu::MENU_ITEM_ACTIVE)
+				{
+					CConcatLineBuffer(&aConcat, &sInactiveText).AppendEnds();
+					CConcatLineBuffer(&aConcat, &sActiveText).Append(szItemNumber, pszItemContent);
+					CConcatLineBuffer(&aConcat, &sDisabledActiveText).AppendEnds();
+				}
+				else
+				{
+					CConcatLineBuffer(&aConcat, &sInactiveText).Append(szItemNumber, pszItemContent);
+					CConcatLineBuffer(&aConcat, &sActiveText).AppendEnds();
+					CConcatLineBuffer(&aConcat, &sDisabledActiveText).Append(szItemNumber, pszItemContent);
+				}
+			}
+			else
+			{
+				CConcatLineBuffer(&aConcat, &sText).Append(pszItemContent);
+
+				if(eItemStyle & IMenu::MENU_ITEM_ACTIVE)
+				{
+					CConcatLineBuffer(&aConcat, &sInactiveText).AppendEnds();
+					CConcatLineBuffer(&aConcat, &sActiveText).Append(pszItemContent);
+					CConcatLineBuffer(&aConcat, &sDisabledActiveText).AppendEnds();
+				}
+				else
+				{
+					CConcatLineBuffer(&aConcat, &sInactiveText).Append(pszItemContent);
+					CConcatLineBuffer(&aConcat, &sActiveText).AppendEnds();
+					CConcatLineBuffer(&aConcat, &sDisabledActiveText).Append(pszItemContent);
+				}
+			}
+		}
+
+		// Append control items.
+		auto *pControlItems = aData.m_pControlItems;
+
+		if(nControlsSum && pControlItems)
+		{
+			CConcatLineBuffer(&aConcat, &sText).AppendEnds();
+			CConcatLineBuffer(&aConcat, &sInactiveText).AppendEnds();
+			CConcatLineBuffer(&aConcat, &sActiveText).AppendEnds();
+			CConcatLineBuffer(&aConcat, &sDisabledActiveText).AppendEnds();
+
+			auto aControlItems = *pControlItems;
+
+			for(const auto &it : aControlItems)
+			{
+				auto i = &it - aControlItems.cbegin();
+
+				auto eControlItem = static_cast<IMenu::ItemControls_t>(-static_cast<IMenu::ItemPosition_t>(i + 1));
+
+				bool bSkipControlItem = (eControlItem == IMenu::MENU_ITEM_CONTROL_BACK_INDEX && (!bHasBackButton || !bItemsHasLeft)) ||
+				                        (eControlItem == IMenu::MENU_ITEM_CONTROL_NEXT_INDEX && (!bHasNextButton || !bItemsOverflow)) ||
+				                        (eControlItem == IMenu::MENU_ITEM_CONTROL_EXIT_INDEX && (!bHasExitButton));
+
+				auto aItemCopy = it;
+
+				if(pHandler)
+				{
+					pHandler->OnMenuDisplayItem(pMenu, aSlot, eControlItem, aItemCopy);
+				}
+
+				const auto &sItemContent = aItemCopy.m_sContent;
+
+				if(sItemContent.IsEmpty())
+				{
+					continue;
+				}
+
+				auto eItemStyle = aItemCopy.m_eStyle;
+
+				const char *pszItemContent = sItemContent.Get();
+
+				if(eItemStyle & IMenu::MENU_ITEM_HASNUMBER)
+				{
+					if(bSkipControlItem)
+					{
+						CConcatLineBuffer(&aConcat, &sText).AppendEnds();
+					}
+					else
+					{
+						szItemNumber[0] = '8' + i;
+
+						if(szItemNumber[0] >= ':')
+						{
+							szItemNumber[0] -= 10;
+						}
+
+						CConcatLineBuffer(&aConcat, &sText).Append(szItemNumber, pszItemContent);
+					}
+
+					if(eItemStyle & IMenu::MENU_ITEM_ACTIVE)
+					{
+						CConcatLineBuffer(&aConcat, &sInactiveText).AppendEnds();
+
+						if(bSkipControlItem)
+						{
+							CConcatLineBuffer(&aConcat, &sActiveText).AppendEnds();
+						}
+						else
+						{
+							CConcatLineBuffer(&aConcat, &sActiveText).Append(szItemNumber, pszItemContent);
+						}
+
+						CConcatLineBuffer(&aConcat, &sDisabledActiveText).AppendEnds();
+					}
+					else
+					{
+						if(bSkipControlItem)
+						{
+							CConcatLineBuffer(&aConcat, &sInactiveText).Append(szItemNumber, pszItemContent);
+						}
+						else
+						{
+							CConcatLineBuffer(&aConcat, &sInactiveText).AppendEnds();
+						}
+
+						CConcatLineBuffer(&aConcat, &sActiveText).AppendEnds();
+						CConcatLineBuffer(&aConcat, &sDisabledActiveText).Append(szItemNumber, pszItemContent);
+					}
+				}
+				else
+				{
+					CConcatLineBuffer(&aConcat, &sText).Append(pszItemContent);
+
+					if(eItemStyle & IMenu::MENU_ITEM_ACTIVE)
+					{
+						CConcatLineBuffer(&aConcat, &sInactiveText).AppendEnds();
+
+						if(bSkipControlItem)
+						{
+							CConcatLineBuffer(&aConcat, &sActiveText).AppendEnds();
+						}
+						else
+						{
+							CConcatLineBuffer(&aConcat, &sActiveText).Append(pszItemContent);
+						}
+
+						CConcatLineBuffer(&aConcat, &sDisabledActiveText).AppendEnds();
+					}
+					else
+					{
+						if(bSkipControlItem)
+						{
+							CConcatLineBuffer(&aConcat, &sInactiveText).AppendEnds();
+						}
+						else
+						{
+							CConcatLineBuffer(&aConcat, &sInactiveText).Append(pszItemContent);
+						}
+
+						CConcatLineBuffer(&aConcat, &sActiveText).AppendEnds();
+						CConcatLineBuffer(&aConcat, &sDisabledActiveText).Append(pszItemContent);
+					}
+				}
+			}
+		}
+	}
+}
+
+// Changes the title, an item content, style and visibility, and a control item.
+class CGoldenHandler : public IMenuHandler
+{
+public:
+	void OnMenuDrawTitle(IMenu *pMenu, CPlayerSlot aSlot, IMenu::Title_t &aTitle) override
+	{
+		aTitle.Set("Drawn title");
+	}
+
+	void OnMenuDisplayItem(IMenu *pMenu, CPlayerSlot aSlot, IMenu::ItemPosition_t iItem, IMenu::Item_t &aData) override
+	{
+		switch(iItem)
+		{
+			case 1:
+			{
+				aData.Set("Changed");
+
+				break;
+			}
+
+			case 2:
+			{
+				aData.m_eStyle = static_cast<IMenu::ItemStyleFlags_t>(aData.m_eStyle ^ IMenu::MENU_ITEM_ACTIVE);
+
+				break;
+			}
+
+			case 4:
+			{
+				aData.Set("");
+
+				break;
+			}
+
+			case IMenu::MENU_ITEM_CONTROL_EXIT_INDEX:
+			{
+				aData.Set("Leave");
+
+				break;
+			}
+
+			default:
+			{
+				break;
+			}
+		}
+	}
+};
+
+static bool CompareLayer(const char *pszCase, const char *pszLayer, const char *pszExpected, const char *pszActual)
+{
+	if(!V_strcmp(pszExpected, pszActual))
+	{
+		return true;
+	}
+
+	std::fprintf(stderr, "%s: the %s layer differs\n--- Expected:\n%s\n--- Actual:\n%s\n---\n", pszCase, pszLayer, pszExpected, pszActual);
+
+	return false;
+}
+
+// Renders fixed menus by the page layer writer and by CConcatLineBuffer, every layer must match.
+bool MenuTest_RenderGolden()
+{
+	static constexpr auto s_eNoStyle = static_cast<IMenu::ItemStyleFlags_t>(0); // Inactive without a number.
+
+	static const IMenu::ItemStyleFlags_t s_arrItemStyles[] =
+	{
+		s_eNoStyle,
+		IMenu::MENU_ITEM_ACTIVE,
+		IMenu::MENU_ITEM_HASNUMBER,
+		IMenu::MENU_ITEM_DEFAULT,
+		IMenu::MENU_ITEM_FULL,
+	};
+
+	static const IMenu::ItemStyleFlags_t s_arrControlStyles[][3] = // Back, next and exit.
+	{
+		{IMenu::MENU_ITEM_DEFAULT, IMenu::MENU_ITEM_DEFAULT, IMenu::MENU_ITEM_DEFAULT},
+		{IMenu::MENU_ITEM_HASNUMBER, IMenu::MENU_ITEM_HASNUMBER, IMenu::MENU_ITEM_HASNUMBER},
+		{IMenu::MENU_ITEM_ACTIVE, IMenu::MENU_ITEM_ACTIVE, IMenu::MENU_ITEM_ACTIVE},
+		{s_eNoStyle, s_eNoStyle, s_eNoStyle},
+		{IMenu::MENU_ITEM_FULL, IMenu::MENU_ITEM_HASNUMBER, s_eNoStyle},
+	};
+
+	static const char *const s_arrTitles[] = {"", "Title"};
+
+	CGoldenHandler aGoldenHandler;
+
+	IMenuHandler *const arrHandlers[] = {nullptr, &aGoldenHandler};
+
+	const CPlayerSlot aSlot(0);
+
+	int nComparedPages = 0,
+	    nComparedFullPages = 0; // With the 10th item.
+
+	for(int iControls = 0; iControls <= IMenu::MENU_ITEM_CONTROL_DEFAULT_FLAGS; iControls++)
+	{
+		const auto eControlFlags = static_cast<IMenu::ItemControlFlags_t>(iControls);
+
+		const uint8 nMaxItems = CMenu::sm_nMaxItemsPerPage - (!!(eControlFlags & IMenu::MENU_ITEM_CONTROL_FLAG_BACK) + !!(eControlFlags & IMenu::MENU_ITEM_CONTROL_FLAG_NEXT) + !!(eControlFlags & IMenu::MENU_ITEM_CONTROL_FLAG_EXIT));
+
+		const int arrItemCounts[] = {0, 3, 2 * nMaxItems + 3};
+
+		for(int nItems : arrItemCounts)
+		{
+			for(const char *pszTitle : s_arrTitles)
+			{
+				for(const auto &arrControlStyles : s_arrControlStyles)
+				{
+					for(auto *pHandler : arrHandlers)
+					{
+						IMenu::Item_t arrControlItems[] = {{arrControlStyles[0], "Back"}, {arrControlStyles[1], "Next"}, {arrControlStyles[2], "Exit"}};
+
+						CMenuData_t::ControlItems_t aControls {&arrControlItems[0], &arrControlItems[1], &arrControlItems[2]};
+
+						CMenu aMenu(nullptr, nullptr, nullptr, nullptr, pHandler, &aControls);
+
+						auto &aData = aMenu.GetData();
+
+						aData.m_title.Set(pszTitle);
+						aData.m_eControlFlags = eControlFlags;
+
+						for(int i = 0; i < nItems; i++)
+						{
+							char szContent[16];
+
+							V_snprintf(szContent, sizeof(szContent), "Item %d", i);
+							aData.m_vecItems.AddToTail({s_arrItemStyles[i % ARRAYSIZE(s_arrItemStyles)], szContent});
+						}
+
+						CMenu::CPageIndex aPageIndex;
+
+						aPageIndex.Build(aData.m_vecItems, nMaxItems);
+
+						for(int iPage = 0; iPage < aPageIndex.Count(); iPage++)
+						{
+							const auto aBounds = aPageIndex.GetBounds(iPage);
+
+							char szCase[128];
+
+							V_snprintf(szCase, sizeof(szCase), "Controls %d, %d items, title \"%s\", control styles %d, %s handler, page %d", iControls, nItems, pszTitle, static_cast<int>(&arrControlStyles - s_arrControlStyles), pHandler ? "a" : "no", iPage);
+
+							CMenu::CPageArena aArena;
+
+							CMenu::CPage aPage;
+
+							ReferencePage_t aReferencePage;
+
+							aPage.Render(&aMenu, aData, aSlot, aBounds, aArena);
+							ReferenceRender(&aMenu, aData, aSlot, aBounds.m_iStartItem, nMaxItems, aReferencePage);
+
+							MENU_TEST_CHECK(CompareLayer(szCase, "text", aReferencePage.m_sText.Get(), aPage.GetText()));
+							MENU_TEST_CHECK(CompareLayer(szCase, "inactive", aReferencePage.m_sInactiveText.Get(), aPage.GetInactiveText()));
+							MENU_TEST_CHECK(CompareLayer(szCase, "active", aReferencePage.m_sActiveText.Get(), aPage.GetActiveText()));
+							MENU_TEST_CHECK(CompareLayer(szCase, "disabled active", aReferencePage.m_sDisabledActiveText.Get(), aPage.GetDisabledActiveText()));
+
+							CMenu::CPageBase aPageBase;
+
+							CMenu::CBufferStringText sReferenceText(MENU_MAX_TEXT_LENGTH);
+
+							aPageBase.Render(&aMenu, aData, aSlot, aBounds, aArena);
+							ReferenceRenderBase(&aMenu, aData, aSlot, aBounds.m_iStartItem, nMaxItems, sReferenceText);
+
+							MENU_TEST_CHECK(CompareLayer(szCase, "base text", sReferenceText.Get(), aPageBase.GetText()));
+
+							if(aBounds.m_iEndItem - aBounds.m_iStartItem == CMenu::sm_nMaxItemsPerPage)
+							{
+								char szTenthLine[32];
+
+								V_snprintf(szTenthLine, sizeof(szTenthLine), "0. Item %d", aBounds.m_iEndItem - 1);
+								MENU_TEST_CHECK(V_strstr(aPage.GetText(), szTenthLine));
+
+								nComparedFullPages++;
+							}
+
+							nComparedPages++;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	MENU_TEST_CHECK(nComparedPages > 0);
+	MENU_TEST_CHECK(nComparedFullPages > 0);
+
+	return true;
+}
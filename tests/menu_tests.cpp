@@ -0,0 +1,64 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Metamod:Source Menu System
+ * Written by Wend4r & komashchenko (Vladimir Ezhikov & Borys Komashchenko).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "menu_tests.hpp"
+
+#include <cstring>
+
+static const MenuTest_t s_arrTests[] =
+{
+	{"menu_render_golden", MenuTest_RenderGolden},
+	{"menu_render_allocations", MenuTest_RenderAllocations},
+	{"menu_allocator_lookup", MenuTest_AllocatorLookup},
+};
+
+// Runs the test by the name, or all of them without.
+int main(int argc, char *argv[])
+{
+	const char *pszName = argc > 1 ? argv[1] : nullptr;
+
+	int nRun = 0,
+	    nFailed = 0;
+
+	for(const auto &aTest : s_arrTests)
+	{
+		if(pszName && std::strcmp(pszName, aTest.m_pszName))
+		{
+			continue;
+		}
+
+		bool bPassed = aTest.m_pfnRun();
+
+		std::printf("%s: %s\n", aTest.m_pszName, bPassed ? "passed" : "FAILED");
+
+		nRun++;
+		nFailed += !bPassed;
+	}
+
+	if(!nRun)
+	{
+		std::fprintf(stderr, "Unknown test \"%s\"\n", pszName);
+
+		return 1;
+	}
+
+	return nFailed ? 1 : 0;
+}
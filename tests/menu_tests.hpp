@@ -0,0 +1,55 @@
+/**
+ * vim: set ts=4 sw=4 tw=99 noet :
+ * ======================================================
+ * Metamod:Source Menu System
+ * Written by Wend4r & komashchenko (Vladimir Ezhikov & Borys Komashchenko).
+ * ======================================================
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef _INCLUDE_METAMOD_SOURCE_MENU_TESTS_HPP_
+#	define _INCLUDE_METAMOD_SOURCE_MENU_TESTS_HPP_
+
+#	pragma once
+
+#	include <cstdio>
+
+// Fails the current test, a test returns false.
+#	define MENU_TEST_CHECK(expr) \
+	do \
+	{ \
+		if(!(expr)) \
+		{ \
+			std::fprintf(stderr, "%s:%d: Check failed: %s\n", __FILE__, __LINE__, #expr); \
+			return false; \
+		} \
+	} while(0)
+
+struct MenuTest_t
+{
+	const char *m_pszName; // By the test target, see "CMakeLists.txt".
+	bool (*m_pfnRun)();
+};
+
+// See "menu_render_test.cpp".
+bool MenuTest_RenderGolden();
+
+// See "menu_allocation_test.cpp".
+bool MenuTest_RenderAllocations();
+
+// See "menu_allocator_test.cpp".
+bool MenuTest_AllocatorLookup();
+
+#endif // _INCLUDE_METAMOD_SOURCE_MENU_TESTS_HPP_